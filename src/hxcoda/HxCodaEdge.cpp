@@ -19,8 +19,14 @@ HxCodaEdge::HxCodaEdge()
     : HxCompModule(HxSpreadSheet::getClassTypeId())
     , m_portDoIt(this, "action", tr("Action"), 1)
     , m_portCoda(this, "coda", tr("Coda"))
+    , m_portMaxRate(this, "maxRate", tr("Max. Rate [Hz]"), 1)
     , m_lastData()
 {
+    // Limit the number of exports per second, so that interactive edits
+    // do not make Coda reload the data on every single change.
+    m_portMaxRate.setMinMax(0.0f, 100.0f);
+    m_portMaxRate.setValue(2.0f);
+
     portData.addType(HxSpatialGraph::getClassTypeId());
     portData.addType(HxLabelAnalysis::getClassTypeId());
     portData.addType(HxUniformScalarField3::getClassTypeId());
@@ -53,6 +59,7 @@ void HxCodaEdge::update()
         if(coda->addEdgeData(currentData))
         {
             m_lastData = currentData;
+            coda->setExportRate(m_lastData, m_portMaxRate.getValue());
         }
         else
         {
@@ -60,6 +67,11 @@ void HxCodaEdge::update()
             portData.disconnect(true);
         }
     }
+
+    if(m_portMaxRate.isNew() && m_lastData)
+    {
+        coda->setExportRate(m_lastData, m_portMaxRate.getValue());
+    }
 }
 
 
@@ -68,6 +80,6 @@ void HxCodaEdge::compute()
     if(m_lastData)
     {
         auto coda = coda::theCoda();
-        coda->writeEdgeData(m_lastData.get());
+        coda->scheduleWriteEdgeData(m_lastData.get());
     }
 }
@@ -1,12 +1,19 @@
 // STL
+#include <algorithm>
+#include <cstdint>
+
+// Qt
+#include <QDebug>
 
 // ZIB
+#include <hxcolor/HxColormap256.h>
 #include <hxspreadsheet/internal/HxSpreadSheet.h>
 #include <hxspatialgraph/internal/HxSpatialGraph.h>
 #include <hxfield/HxUniformLabelField3.h>
 
 // Local
 #include <hxcoda/HxCodaEdgeFilter.h>
+#include <hxcoda/internal/BrickedFilter.h>
 #include <hxcoda/internal/Coda.h>
 
 
@@ -17,8 +24,45 @@ HxCodaEdgeFilter::HxCodaEdgeFilter()
     : HxCompModule(HxSpreadSheet::getClassTypeId())
     , m_portDoIt(this, "action", tr("Action"), 1)
     , m_portCoda(this, "coda", tr("Coda"))
+    , m_portOutput(this, "output", tr("Output"), 6)
+    , m_portOptions(this, "options", tr("Options"), 2)
+    , m_portSourceFile(this, "sourceFile", tr("Source File"))
+    , m_portOutputFile(this, "outputFile", tr("Output File"))
+    , m_portSlice(this, "slice", tr("Slice"))
+    , m_portCacheBudget(this, "cacheBudget", tr("Cache Budget [MB]"), 1)
     , m_qtContext()
+    , m_labelFilterCache()
+    , m_lazyField()
+    , m_subgraphCache()
+    , m_rowIndices()
+    , m_backgroundFilter()
+    , m_maskedField()
+    , m_maskBaseColormap()
 {
+    m_portOutput.setLabel(OUTPUT_COPY, tr("Filtered Copy"));
+    m_portOutput.setLabel(OUTPUT_MASK, tr("Colormap Mask"));
+    m_portOutput.setLabel(OUTPUT_FILE, tr("Bricked File"));
+    m_portOutput.setLabel(OUTPUT_SLICE, tr("Lazy Slice"));
+    m_portOutput.setLabel(OUTPUT_ATTRIBUTE, tr("Selection Attribute"));
+    m_portOutput.setLabel(OUTPUT_TABLE, tr("Compact Table"));
+    m_portOutput.setValue(OUTPUT_COPY);
+
+    m_portOptions.setLabel(OPTION_COMPACT, tr("Compact Labels"));
+    m_portOptions.setValue(OPTION_COMPACT, 0);
+    m_portOptions.setLabel(OPTION_BACKGROUND, tr("Background"));
+    m_portOptions.setValue(OPTION_BACKGROUND, 1);
+
+    // The source file is optional. It allows to filter an AmiraMesh label 
+    // volume which is too large to be loaded, e.g. while a downsampled
+    // version of it is attached to the module.
+    m_portSourceFile.setMode(HxPortFilename::EXISTING_FILE);
+    m_portOutputFile.setMode(HxPortFilename::ANY_FILE);
+
+    // Keep the filtered spatialgraphs of the recent selections, so that
+    // toggling between selections does not filter the graph again.
+    m_portCacheBudget.setMinMax(0.0f, 65536.0f);
+    m_portCacheBudget.setValue(256.0f);
+
     portData.addType(HxSpatialGraph::getClassTypeId());
     portData.addType(HxUniformLabelField3::getClassTypeId());
 
@@ -26,18 +70,85 @@ HxCodaEdgeFilter::HxCodaEdgeFilter()
     QObject::connect(coda.get(), &coda::Coda::edgeSelectionChanged, &m_qtContext, [this](){
         this->compute();
     });
+    QObject::connect(&m_backgroundFilter, &coda::BackgroundLabelFilter::finished, &m_qtContext, [this](){
+        this->on_backgroundFilter_finished();
+    });
 }
 
 
 HxCodaEdgeFilter::~HxCodaEdgeFilter()
-{}
+{
+    restoreMaskedField();
+    coda::theCoda()->removeParentGraph(dynamic_cast<HxSpatialGraph*>(getResult()));
+}
 
 
 void HxCodaEdgeFilter::update()
 {
     // Attach tight to spreadsheets since we only change the selection
-    // in the spreadsheet and don't create a new result.
-    portData.setTightness(!!hxconnection_cast<HxSpreadSheet>(portData));
+    // in the spreadsheet and don't create a new result, unless the 
+    // selected rows are gathered into a compact table.
+    portData.setTightness(
+        !!hxconnection_cast<HxSpreadSheet>(portData) 
+        && m_portOutput.getValue() != OUTPUT_TABLE
+    );
+
+    // The voxel index of a label field and the adjacency index of a 
+    // spatialgraph are only valid as long as the input does not change.
+    if(portData.isNew())
+    {
+        m_labelFilterCache.invalidate();
+        m_lazyField.clear();
+        m_backgroundFilter.invalidate();
+
+        // Writing a selection attribute or colors does not change the
+        // topology.
+        auto graph = hxconnection_cast<HxSpatialGraph>(portData);
+        if(graph && !coda::theCoda()->isChangingAttributes())
+        {
+            coda::theCoda()->invalidateAdjacency(graph);
+            m_subgraphCache.clear();
+        }
+    }
+
+    if(m_portCacheBudget.isNew())
+    {
+        m_subgraphCache.setMaxBytes(static_cast<std::int64_t>(m_portCacheBudget.getValue()*1024.0*1024.0));
+    }
+
+    // The output modes are only available for label fields, spatialgraphs
+    // and spreadsheets. Spatialgraphs only support a filtered copy and the
+    // selection attribute, spreadsheets only the compact table.
+    const bool isLabelField = !!hxconnection_cast<HxUniformLabelField3>(portData);
+    const bool isGraph = !!hxconnection_cast<HxSpatialGraph>(portData);
+    const bool isSpreadSheet = !!hxconnection_cast<HxSpreadSheet>(portData);
+    m_portOutput.setVisible(isLabelField || isGraph || isSpreadSheet);
+    m_portOptions.setVisible(isLabelField && m_portOutput.getValue() == OUTPUT_COPY);
+    m_portSourceFile.setVisible(isLabelField && m_portOutput.getValue() == OUTPUT_FILE);
+    m_portOutputFile.setVisible(isLabelField && m_portOutput.getValue() == OUTPUT_FILE);
+    m_portSlice.setVisible(isLabelField && m_portOutput.getValue() == OUTPUT_SLICE);
+    m_portCacheBudget.setVisible(isGraph && m_portOutput.getValue() != OUTPUT_ATTRIBUTE);
+
+    // The fields of the background filter are only kept while label 
+    // fields are filtered in the background.
+    if(!isLabelField || m_portOutput.getValue() != OUTPUT_COPY || !m_portOptions.getValue(OPTION_BACKGROUND))
+    {
+        m_backgroundFilter.clear();
+    }
+
+    if(auto input = hxconnection_cast<HxUniformLabelField3>(portData))
+    {
+        m_portSlice.setMinMax(0, std::max(0, static_cast<int>(input->lattice().getDims().nz) - 1));
+    }
+
+    // Give the masked label field its original colormap back when
+    // it is no longer masked by this module.
+    if(m_maskedField && (
+        m_portOutput.getValue() != OUTPUT_MASK 
+        || m_maskedField != hxconnection_cast<HxUniformLabelField3>(portData)
+    )) {
+        restoreMaskedField();
+    }
 }
 
 
@@ -45,35 +156,169 @@ void HxCodaEdgeFilter::compute()
 {
     auto coda = coda::theCoda();
 
-    if(!m_portDoIt.wasHit())
+    // Browsing the slices of the lazy output does not require 
+    // to press the apply button.
+    const bool isSliceRequest = m_portSlice.isNew() && m_portOutput.getValue() == OUTPUT_SLICE;
+    if(!m_portDoIt.wasHit() && !isSliceRequest)
     {
         return;
     }
 
+    // A new computation supersedes the one running in the background.
+    m_backgroundFilter.cancel();
+
     McHandle<HxData> filteredData;
+    McHandle<HxData> mappingData;
+    bool isPending = false;
+
+    auto input_sheet = McHandle<HxSpreadSheet>(hxconnection_cast<HxSpreadSheet>(portData));
+
+    // Gather the selected rows of an attached spreadsheet into a compact
+    // table. The table and the index list are reused, so only the rows
+    // are copied when the selection changes.
+    if(input_sheet && m_portOutput.getValue() == OUTPUT_TABLE)
+    {
+        auto filtered = McHandle<HxSpreadSheet>(dynamic_cast<HxSpreadSheet*>(getResult()));
+        if(!filtered)
+        {
+            filtered = HxSpreadSheet::createInstance();
+            filtered->composeLabel(input_sheet->getLabel(), "coda_filtered");
+        }
+
+        coda::selectedRows(m_rowIndices, input_sheet, coda->edgeSelection(), coda->edgeTableSelections());
+        coda::gatherRows(filtered, input_sheet, m_rowIndices);
+        filteredData = filtered;
+    }
 
     // Filter an attached spreadsheet.
-    if(auto input = McHandle<HxSpreadSheet>(hxconnection_cast<HxSpreadSheet>(portData)))
+    else if(auto input = input_sheet)
     {
-        coda::select(input, coda->edgeSelection());
+        coda::select(input, coda->edgeSelection(), coda->edgeTableSelections());
+        filteredData.release();
+    }
+
+    // Write the selection into an attribute of an attached spatialgraph. Only
+    // the attribute values change, so the renderers can hide or dim the 
+    // unselected items with a colormap without rebuilding the geometry.
+    auto input_graph = McHandle<HxSpatialGraph>(hxconnection_cast<HxSpatialGraph>(portData));
+    if(input_graph && m_portOutput.getValue() == OUTPUT_ATTRIBUTE)
+    {
+        // The synchronized graph is not exported again and its topology
+        // is kept.
+        coda::markEdges(input_graph, coda->edgeSelection(input_graph));
+        coda->fireAttributeChange(input_graph);
         filteredData.release();
     }
 
     // Filter an attached spatialgraph.
-    if(auto input = McHandle<HxSpatialGraph>(hxconnection_cast<HxSpatialGraph>(portData)))
+    else if(auto input = input_graph)
     {
-        auto filtered = McHandle<HxSpatialGraph>(dynamic_cast<HxSpatialGraph*>(getResult()));
+        // Selections made on a filtered child of the graph are 
+        // mapped back to the graph.
+        const std::vector<bool> selection = coda->edgeSelection(input);
+
+        // Show the result of a recent selection directly. Since the cache 
+        // shares its graphs, a new selection is never filtered into a
+        // cached graph.
+        const std::uint64_t stamp = coda->graphStamp(input);
+        auto filtered = McHandle<HxSpatialGraph>(m_subgraphCache.find(input, stamp, selection));
         if(!filtered)
         {
-            filtered = HxSpatialGraph::createInstance();
+            filtered = dynamic_cast<HxSpatialGraph*>(getResult());
+            if(!filtered || m_subgraphCache.contains(filtered))
+            {
+                filtered = HxSpatialGraph::createInstance();
+            }
+            coda::filterEdges(filtered, input, selection);
+            m_subgraphCache.insert(input, stamp, selection, filtered);
+        }
+        if(filtered != getResult())
+        {
             filtered->composeLabel(input->getLabel(), "coda_filtered");
         }
-        coda::filterEdges(filtered, input, coda->edgeSelection());
         filteredData = filtered;
     }
 
+    auto input_field = McHandle<HxUniformLabelField3>(hxconnection_cast<HxUniformLabelField3>(portData));
+
+    // Stream an attached label field, or the label volume in the source
+    // file, brick by brick into the output file.
+    if(input_field && m_portOutput.getValue() == OUTPUT_FILE)
+    {
+        const QString sourcePath = m_portSourceFile.getFilename();
+        const QString outputPath = m_portOutputFile.getFilename();
+        if(outputPath.isEmpty())
+        {
+            qWarning() << "An output file is required.";
+        }
+        else if(!sourcePath.isEmpty())
+        {
+            coda::filterBricked(outputPath, sourcePath, coda->edgeSelection());
+        }
+        else
+        {
+            coda::filterBricked(outputPath, input_field, coda->edgeSelection());
+        }
+        filteredData.release();
+    }
+
+    // Filter only the requested slice of an attached label field. Changing 
+    // the selection only resets the slice cache.
+    else if(input_field && m_portOutput.getValue() == OUTPUT_SLICE)
+    {
+        auto filtered = McHandle<HxUniformLabelField3>(dynamic_cast<HxUniformLabelField3*>(getResult()));
+        if(!filtered)
+        {
+            filtered = HxUniformLabelField3::createInstance();
+            filtered->composeLabel(input_field->getLabel(), "coda_slice");
+        }
+
+        m_lazyField.setInput(input_field);
+        m_lazyField.setSelection(coda->edgeSelection());
+        if(!m_lazyField.sliceToField(filtered, m_portSlice.getValue()))
+        {
+            qWarning() << "The label field must be of type uint8, uint16 or int32.";
+        }
+        filteredData = filtered;
+    }
+
+    // Mask an attached label field with a colormap.
+    else if(input_field && m_portOutput.getValue() == OUTPUT_MASK)
+    {
+        auto mask = McHandle<HxColormap256>(dynamic_cast<HxColormap256*>(getResult()));
+        if(!mask)
+        {
+            mask = HxColormap256::createInstance();
+            mask->composeLabel(input_field->getLabel(), "coda_mask");
+        }
+
+        // Remember the original colormap, so that the mask can reuse its
+        // colors and it can be restored later.
+        if(input_field->portSharedColormap.getColormap() != mask.get())
+        {
+            m_maskBaseColormap = input_field->portSharedColormap.getColormap();
+            if(!m_maskBaseColormap)
+            {
+                m_maskBaseColormap = input_field->portSharedColormap.getDefaultColormap();
+            }
+        }
+
+        float min_label = 0.0f;
+        float max_label = 0.0f;
+        input_field->getRange(min_label, max_label);
+        
+        coda::colormapMask(mask, m_maskBaseColormap, coda->edgeSelection(), static_cast<int>(max_label) + 1);
+        
+        if(input_field->portSharedColormap.getColormap() != mask.get())
+        {
+            input_field->portSharedColormap.connect(mask);
+            m_maskedField = input_field;
+        }
+        filteredData = mask;
+    }
+
     // Filter an attached label field.
-    if(auto input = McHandle<HxUniformLabelField3>(hxconnection_cast<HxUniformLabelField3>(portData)))
+    else if(auto input = input_field)
     {
         auto filtered = McHandle<HxUniformLabelField3>(dynamic_cast<HxUniformLabelField3*>(getResult()));
         if(!filtered)
@@ -81,16 +326,114 @@ void HxCodaEdgeFilter::compute()
             filtered = HxUniformLabelField3::createInstance();
             filtered->lattice().setPrimType(McPrimType::MC_INT32);
             filtered->composeLabel(input->getLabel(), "coda_filtered");
+            m_labelFilterCache.invalidate();
+        }
+
+        // Relabel the remaining labels and output the mapping to the
+        // original labels.
+        if(m_portOptions.getValue(OPTION_COMPACT))
+        {
+            auto mapping = McHandle<HxSpreadSheet>(dynamic_cast<HxSpreadSheet*>(getResult(1)));
+            if(!mapping)
+            {
+                mapping = HxSpreadSheet::createInstance();
+                mapping->composeLabel(input->getLabel(), "coda_labels");
+            }
+            if(coda::filterCompact(filtered, input, coda->edgeSelection(), mapping))
+            {
+                mappingData = mapping;
+            }
+            else
+            {
+                qWarning() << "The label field must be of type uint8, uint16 or int32.";
+            }
+
+            // The result no longer contains the original labels.
+            m_labelFilterCache.valid = false;
+            m_backgroundFilter.clear();
+        }
+        // Filter into the back field on a worker thread. The result keeps
+        // showing the last complete selection until the back field replaces
+        // it in on_backgroundFilter_finished().
+        else if(m_portOptions.getValue(OPTION_BACKGROUND) && m_backgroundFilter.start(input, coda->edgeSelection()))
+        {
+            m_labelFilterCache.valid = false;
+            isPending = true;
+        }
+        else
+        {
+            // The result may be a field of the background filter, which 
+            // no longer knows its content.
+            m_backgroundFilter.clear();
+            coda::filter(filtered, input, coda->edgeSelection(), m_labelFilterCache);
         }
-        coda::filter(filtered, input, coda->edgeSelection());
         filteredData = filtered;
     }
 
+    // A replaced spatialgraph no longer maps selections back to its input,
+    // unless it is still cached for another selection.
+    auto previousGraph = dynamic_cast<HxSpatialGraph*>(getResult());
+    if(previousGraph && previousGraph != filteredData.get() && !m_subgraphCache.contains(previousGraph))
+    {
+        coda->removeParentGraph(previousGraph);
+    }
+
     // Set the result.    
-    if(filteredData)
+    if(filteredData && !isPending)
     {
         filteredData->touch();
         filteredData->fire();
     }
     setResult(filteredData);
+
+    if(mappingData)
+    {
+        mappingData->touch();
+        mappingData->fire();
+    }
+    setResult(1, mappingData);
+}
+
+
+void HxCodaEdgeFilter::restoreMaskedField()
+{
+    if(!m_maskedField)
+    {
+        return;
+    }
+
+    if(m_maskedField->portSharedColormap.getColormap() == getResult())
+    {
+        if(m_maskBaseColormap && m_maskBaseColormap != m_maskedField->portSharedColormap.getDefaultColormap())
+        {
+            m_maskedField->portSharedColormap.connect(m_maskBaseColormap);
+        }
+        else
+        {
+            m_maskedField->portSharedColormap.disconnect();
+        }
+    }
+
+    m_maskedField.release();
+    m_maskBaseColormap.release();
 }
+
+
+void HxCodaEdgeFilter::on_backgroundFilter_finished()
+{
+    // The completed back field replaces the result. The former result
+    // becomes the back field of the next run.
+    auto filtered = McHandle<HxUniformLabelField3>(m_backgroundFilter.takeResult());
+    if(!filtered)
+    {
+        return;
+    }
+
+    if(auto input = hxconnection_cast<HxUniformLabelField3>(portData))
+    {
+        filtered->composeLabel(input->getLabel(), "coda_filtered");
+    }
+    filtered->touch();
+    filtered->fire();
+    setResult(filtered);
+}
\ No newline at end of file
@@ -7,10 +7,22 @@
 // ZIB
 #include <hxcore/HxCompModule.h>
 #include <hxcore/HxPortDoIt.h>
+#include <hxcore/HxPortFilename.h>
+#include <hxcore/HxPortFloatTextN.h>
+#include <hxcore/HxPortIntSlider.h>
+#include <hxcore/HxPortRadioBox.h>
+#include <hxcore/HxPortToggleList.h>
+#include <hxcolor/HxColormap.h>
+#include <hxfield/HxUniformLabelField3.h>
 
 // Local
 #include <hxcoda/api.h>
+#include <hxcoda/internal/BackgroundLabelFilter.h>
+#include <hxcoda/internal/Coda.h>
+#include <hxcoda/internal/LazyLabelField.h>
 #include <hxcoda/internal/PortCoda.h>
+#include <hxcoda/internal/SpreadSheetFilter.h>
+#include <hxcoda/internal/SubgraphCache.h>
 
 
 /**
@@ -26,11 +38,76 @@ HX_HEADER(HxCodaEdgeFilter);
 
 public:
 
+    /// The output modes of the filter.
+    enum OutputMode
+    {
+        /// Create a filtered copy of the input.
+        OUTPUT_COPY = 0,
+        /// Hide unselected labels of a label field with a colormap
+        /// instead of creating a filtered copy.
+        OUTPUT_MASK = 1,
+        /// Stream the filtered label field into a file on disk
+        /// without keeping a filtered copy in memory.
+        OUTPUT_FILE = 2,
+        /// Filter only the requested slice of a label field.
+        OUTPUT_SLICE = 3,
+        /// Write the selection into an attribute of a spatialgraph
+        /// instead of creating a filtered copy.
+        OUTPUT_ATTRIBUTE = 4,
+        /// Gather the selected rows of a spreadsheet into a new,
+        /// compact spreadsheet instead of selecting them in place.
+        OUTPUT_TABLE = 5
+    };
+
+    /// The options of the filter.
+    enum Option
+    {
+        /// Number the remaining labels consecutively and store them
+        /// in the smallest possible integer type.
+        OPTION_COMPACT = 0,
+        /// Filter on a worker thread and keep showing the last 
+        /// result until the new one is complete.
+        OPTION_BACKGROUND = 1
+    };
+
     virtual void update() override;
     virtual void compute() override;
 
     HxPortDoIt m_portDoIt;
     PortCoda m_portCoda;
+    HxPortRadioBox m_portOutput;
+    HxPortToggleList m_portOptions;
+    HxPortFilename m_portSourceFile;
+    HxPortFilename m_portOutputFile;
+    HxPortIntSlider m_portSlice;
+    HxPortFloatTextN m_portCacheBudget;
     QObject m_qtContext;
+
+    /// Allows to update a filtered label field incrementally.
+    coda::LabelFilterCache m_labelFilterCache;
+
+    /// Filters the slices of a label field on demand.
+    coda::LazyLabelField m_lazyField;
+
+    /// The recently filtered spatialgraphs.
+    coda::SubgraphCache m_subgraphCache;
+
+    /// The indices of the selected rows of a spreadsheet, reused 
+    /// between selection changes.
+    coda::RowIndices m_rowIndices;
+
+    /// Filters label fields on a worker thread.
+    coda::BackgroundLabelFilter m_backgroundFilter;
+
+    /// The label field masked with the colormap mask and its
+    /// original colormap.
+    McHandle<HxUniformLabelField3> m_maskedField;
+    McHandle<HxColormap> m_maskBaseColormap;
+
+protected:
+
+    void restoreMaskedField();
+
+    void on_backgroundFilter_finished();
 };
 
@@ -0,0 +1,90 @@
+// STL
+#include <limits>
+
+// Qt
+#include <QDebug>
+
+// ZIB
+#include <hxspreadsheet/internal/HxSpreadSheet.h>
+#include <hxspatialgraph/internal/HxSpatialGraph.h>
+#include <hxfield/HxUniformLabelField3.h>
+
+// Local
+#include <hxcoda/HxCodaEdgeSelection.h>
+#include <hxcoda/internal/Coda.h>
+#include <hxcoda/internal/SpreadSheetFilter.h>
+
+
+HX_INIT_CLASS(HxCodaEdgeSelection, HxCompModule)
+
+
+HxCodaEdgeSelection::HxCodaEdgeSelection()
+    : HxCompModule(HxSpreadSheet::getClassTypeId())
+    , m_portDoIt(this, "action", tr("Action"), 1)
+    , m_portCoda(this, "coda", tr("Coda"))
+    , m_qtContext()
+    , m_writtenSelection()
+{
+    // Attach tight to the "dummy" data object since it should 
+    // not be of real other use than being a dummy.
+    portData.setTightness(true);
+
+    auto coda = coda::theCoda();
+    QObject::connect(coda.get(), &coda::Coda::edgeSelectionChanged, &m_qtContext, [this](){
+        this->compute();
+    });
+}
+
+
+HxCodaEdgeSelection::~HxCodaEdgeSelection()
+{}
+
+
+void HxCodaEdgeSelection::update()
+{}
+
+
+void HxCodaEdgeSelection::compute()
+{
+    auto coda = coda::theCoda();
+
+    const auto& edgeSelection = coda->edgeSelection();
+    if(edgeSelection.size() > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+    {
+        qWarning() << "The edge selection exceeds the row limit of a spreadsheet.";
+        return;
+    }
+    const int nrows = static_cast<int>(edgeSelection.size());
+
+    // This module only outputs data. So we can just ignore all inputs.
+    McHandle<HxSpreadSheet> filteredData = dynamic_cast<HxSpreadSheet*>(getResult());
+    if(!filteredData)
+    {
+        filteredData = HxSpreadSheet::createInstance();
+        filteredData->setLabel("CodaEdgeSelection");
+    }    
+
+    // Reuse the spreadsheet and the selection column as long as the number
+    // of rows does not change. Otherwise, all rows are written again.
+    int icol = filteredData->findColumn("selected", HxSpreadSheet::Column::INT);
+    if(icol < 0 || filteredData->nRows() != nrows)
+    {
+        filteredData->clear();
+        filteredData->setNumRows(nrows);
+        filteredData->addColumn("selected", HxSpreadSheet::Column::INT);
+        icol = filteredData->findColumn("selected", HxSpreadSheet::Column::INT);
+        m_writtenSelection.clear();
+    }
+
+    // Populate the selection column.
+    coda::updateSelectionColumn(filteredData->column(icol), edgeSelection, m_writtenSelection);
+    m_writtenSelection = edgeSelection;
+    
+    // Set the result.
+    if(filteredData)
+    {
+        filteredData->touch();
+        filteredData->fire();
+    }
+    setResult(filteredData);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// Qt
+#include <QScopedPointer>
+#include <QObject>
+
+// ZIB
+#include <hxcore/HxCompModule.h>
+#include <hxcore/HxPortDoIt.h>
+
+// Local
+#include <hxcoda/api.h>
+#include <hxcoda/internal/PortCoda.h>
+
+
+/**
+ * @brief HxCodaEdgeSelection
+ * 
+ * This module makes the current Coda edge selection (indices)
+ * available in Amira as a spreadsheet. The spreadsheet can 
+ * for example be used in the Codal segmenter module to mask
+ * out other labels.
+ * 
+ * TODO: It would be cool to be able to create this module without
+ *       a dummy data object.
+ */
+class HXCODA_API HxCodaEdgeSelection : public HxCompModule
+{
+HX_HEADER(HxCodaEdgeSelection);
+
+public:
+
+    virtual void update() override;
+    virtual void compute() override;
+
+    HxPortDoIt m_portDoIt;
+    PortCoda m_portCoda;
+    QObject m_qtContext;
+
+    /// The selection written into the result, so that only the
+    /// changed rows are written when the selection changes.
+    std::vector<bool> m_writtenSelection;
+};
+
@@ -15,14 +15,47 @@ HxCodaGraph::HxCodaGraph()
     : HxCompModule(HxSpatialGraph::getClassTypeId())
     , m_portDoIt(this, "action", tr("Action"), 1)
     , m_portCoda(this, "coda", tr("Coda"))
+    , m_portMaxRate(this, "maxRate", tr("Max. Rate [Hz]"), 1)
+    , m_portPropagation(this, "propagation", tr("Propagation"), 4)
+    , m_portExpansion(this, "expansion", tr("Expansion"), 3)
+    , m_portHops(this, "hops", tr("Hops"))
     , m_lastData()
 {
+    // Limit the number of exports per second, so that interactive edits
+    // do not make Coda reload the data on every single change.
+    m_portMaxRate.setMinMax(0.0f, 100.0f);
+    m_portMaxRate.setValue(2.0f);
+
+    m_portPropagation.setLabel(coda::Coda::PROPAGATE_NONE, tr("None"));
+    m_portPropagation.setLabel(coda::Coda::PROPAGATE_INDUCED_EDGES, tr("Induced Edges"));
+    m_portPropagation.setLabel(coda::Coda::PROPAGATE_INCIDENT_EDGES, tr("Incident Edges"));
+    m_portPropagation.setLabel(coda::Coda::PROPAGATE_ENDPOINTS, tr("Endpoints"));
+    m_portPropagation.setValue(coda::Coda::PROPAGATE_NONE);
+
+    m_portExpansion.setLabel(coda::Coda::EXPAND_NONE, tr("None"));
+    m_portExpansion.setLabel(coda::Coda::EXPAND_NEIGHBOURHOOD, tr("Neighbourhood"));
+    m_portExpansion.setLabel(coda::Coda::EXPAND_COMPONENTS, tr("Components"));
+    m_portExpansion.setValue(coda::Coda::EXPAND_NONE);
+
+    m_portHops.setMinMax(0, 16);
+    m_portHops.setValue(1);
+
     portData.setTightness(true);
 }
 
 
 HxCodaGraph::~HxCodaGraph()
-{}
+{
+    auto coda = coda::theCoda();
+    if(m_lastData && coda->propagation() != coda::Coda::PROPAGATE_NONE)
+    {
+        coda->setPropagation(nullptr, coda::Coda::PROPAGATE_NONE);
+    }
+    if(m_lastData && coda->expansion() != coda::Coda::EXPAND_NONE)
+    {
+        coda->setExpansion(nullptr, coda::Coda::EXPAND_NONE, 0);
+    }
+}
 
 
 void HxCodaGraph::update()
@@ -34,6 +67,7 @@ void HxCodaGraph::update()
     McHandle<HxData> currentData = hxconnection_cast<HxData>(portData);
     if(m_lastData && currentData != m_lastData)
     {
+        coda->invalidateAdjacency(dynamic_cast<HxSpatialGraph*>(m_lastData.get()));
         coda->removeVertexData(m_lastData);
         coda->removeEdgeData(m_lastData);
         m_lastData.release();
@@ -46,6 +80,7 @@ void HxCodaGraph::update()
         if(coda->addVertexData(currentData) && coda->addEdgeData(currentData))
         {
             m_lastData = currentData;
+            coda->setExportRate(m_lastData, m_portMaxRate.getValue());
         }
         else
         {
@@ -55,15 +90,57 @@ void HxCodaGraph::update()
             portData.disconnect(true);
         }
     }
+
+    if(m_portMaxRate.isNew() && m_lastData)
+    {
+        coda->setExportRate(m_lastData, m_portMaxRate.getValue());
+    }
+
+    // The topology of the graph may have changed, unless hxcoda only
+    // wrote some attribute values, e.g. a selection attribute.
+    const bool isDataNew = portData.isNew() && !coda->isChangingAttributes();
+    if(isDataNew && m_lastData)
+    {
+        coda->invalidateAdjacency(dynamic_cast<HxSpatialGraph*>(m_lastData.get()));
+    }
+
+    // Derive one selection from the other using the topology of the graph.
+    if(isDataNew || m_portPropagation.isNew())
+    {
+        const auto propagation = static_cast<coda::Coda::Propagation>(m_portPropagation.getValue());
+        if(m_lastData)
+        {
+            coda->setPropagation(dynamic_cast<HxSpatialGraph*>(m_lastData.get()), propagation);
+        }
+        else if(coda->propagation() != coda::Coda::PROPAGATE_NONE)
+        {
+            coda->setPropagation(nullptr, coda::Coda::PROPAGATE_NONE);
+        }
+    }
+
+    // Grow the selections along the graph.
+    m_portHops.setVisible(m_portExpansion.getValue() == coda::Coda::EXPAND_NEIGHBOURHOOD);
+    if(isDataNew || m_portExpansion.isNew() || m_portHops.isNew())
+    {
+        const auto expansion = static_cast<coda::Coda::Expansion>(m_portExpansion.getValue());
+        if(m_lastData)
+        {
+            coda->setExpansion(dynamic_cast<HxSpatialGraph*>(m_lastData.get()), expansion, m_portHops.getValue());
+        }
+        else if(coda->expansion() != coda::Coda::EXPAND_NONE)
+        {
+            coda->setExpansion(nullptr, coda::Coda::EXPAND_NONE, 0);
+        }
+    }
 }
 
 
 void HxCodaGraph::compute()
 {    
-    if(m_lastData)
+    auto coda = coda::theCoda();
+    if(m_lastData && !coda->isChangingAttributes())
     {
-        auto coda = coda::theCoda();
-        coda->writeVertexData(m_lastData.get());
-        coda->writeEdgeData(m_lastData.get());
+        coda->scheduleWriteVertexData(m_lastData.get());
+        coda->scheduleWriteEdgeData(m_lastData.get());
     }
 }
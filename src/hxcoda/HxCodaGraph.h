@@ -3,6 +3,9 @@
 // ZIB
 #include <hxcore/HxCompModule.h>
 #include <hxcore/HxPortDoIt.h>
+#include <hxcore/HxPortFloatTextN.h>
+#include <hxcore/HxPortIntSlider.h>
+#include <hxcore/HxPortRadioBox.h>
 
 // Local
 #include <hxcoda/api.h>
@@ -14,6 +17,10 @@
  * 
  * This module can be attached to a spatialgraph and makes
  * its vertices and edges available in Coda.
+ *
+ * Optionally, the edge selection in Coda is derived from the vertex
+ * selection or vice versa, see coda::Coda::setPropagation(), and the
+ * selections are grown along the graph, see coda::Coda::setExpansion().
  */
 class HXCODA_API HxCodaGraph : public HxCompModule
 {
@@ -26,6 +33,10 @@ public:
 
     HxPortDoIt m_portDoIt;
     PortCoda m_portCoda;
+    HxPortFloatTextN m_portMaxRate;
+    HxPortRadioBox m_portPropagation;
+    HxPortRadioBox m_portExpansion;
+    HxPortIntSlider m_portHops;
     McHandle<HxData> m_lastData;
 };
 
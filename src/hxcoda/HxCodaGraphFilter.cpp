@@ -0,0 +1,96 @@
+// STL
+
+// ZIB
+#include <hxspatialgraph/internal/HxSpatialGraph.h>
+
+// Local
+#include <hxcoda/HxCodaGraphFilter.h>
+#include <hxcoda/internal/Coda.h>
+
+
+HX_INIT_CLASS(HxCodaGraphFilter, HxCompModule)
+
+
+HxCodaGraphFilter::HxCodaGraphFilter()
+    : HxCompModule(HxSpatialGraph::getClassTypeId())
+    , m_portDoIt(this, "action", tr("Action"), 1)
+    , m_portCoda(this, "coda", tr("Coda"))
+    , m_portCombination(this, "combination", tr("Combination"), 2)
+    , m_qtContext()
+{
+    m_portCombination.setLabel(COMBINE_INTERSECTION, tr("Intersection"));
+    m_portCombination.setLabel(COMBINE_UNION, tr("Union"));
+    m_portCombination.setValue(COMBINE_INTERSECTION);
+
+    auto coda = coda::theCoda();
+    QObject::connect(coda.get(), &coda::Coda::vertexSelectionChanged, &m_qtContext, [this](){
+        this->compute();
+    });
+    QObject::connect(coda.get(), &coda::Coda::edgeSelectionChanged, &m_qtContext, [this](){
+        this->compute();
+    });
+}
+
+
+HxCodaGraphFilter::~HxCodaGraphFilter()
+{
+    coda::theCoda()->removeParentGraph(dynamic_cast<HxSpatialGraph*>(getResult()));
+}
+
+
+void HxCodaGraphFilter::update()
+{
+    // The adjacency index is only valid as long as the graph
+    // does not change. Writing attribute values keeps the topology.
+    if(portData.isNew() && !coda::theCoda()->isChangingAttributes())
+    {
+        if(auto graph = hxconnection_cast<HxSpatialGraph>(portData))
+        {
+            coda::theCoda()->invalidateAdjacency(graph);
+        }
+    }
+}
+
+
+void HxCodaGraphFilter::compute()
+{
+    auto coda = coda::theCoda();
+
+    if(!m_portDoIt.wasHit())
+    {
+        return;
+    }
+
+    McHandle<HxData> filteredData;
+
+    // Filter the attached spatialgraph.
+    if(auto input = McHandle<HxSpatialGraph>(hxconnection_cast<HxSpatialGraph>(portData)))
+    {
+        auto filtered = McHandle<HxSpatialGraph>(dynamic_cast<HxSpatialGraph*>(getResult()));
+        if(!filtered)
+        {
+            filtered = HxSpatialGraph::createInstance();
+            filtered->composeLabel(input->getLabel(), "coda_filtered");
+        }
+        coda::filterGraph(
+            filtered, input, coda->vertexSelection(input), coda->edgeSelection(input),
+            m_portCombination.getValue() == COMBINE_UNION
+        );
+        filteredData = filtered;
+    }
+
+    // A replaced spatialgraph no longer maps selections back to its input.
+    auto previousGraph = dynamic_cast<HxSpatialGraph*>(getResult());
+    if(previousGraph && previousGraph != filteredData.get())
+    {
+        coda->removeParentGraph(previousGraph);
+    }
+
+    // Set the result.
+    if(filteredData)
+    {
+        filteredData->touch();
+        filteredData->fire();
+    }
+    setResult(filteredData);
+}
\ No newline at end of file
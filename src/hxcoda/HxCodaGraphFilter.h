@@ -0,0 +1,47 @@
+#pragma once
+
+// Qt
+#include <QObject>
+
+// ZIB
+#include <hxcore/HxCompModule.h>
+#include <hxcore/HxPortDoIt.h>
+#include <hxcore/HxPortRadioBox.h>
+
+// Local
+#include <hxcoda/api.h>
+#include <hxcoda/internal/PortCoda.h>
+
+
+/**
+ * @brief HxCodaGraphFilter
+ *
+ * This module applies the current vertex and edge selection
+ * in Coda at once as a filter to the attached spatialgraph.
+ *
+ * Unlike chaining the vertex and edge filter, the graph is only
+ * traversed once and a single subgraph is created.
+ */
+class HXCODA_API HxCodaGraphFilter : public HxCompModule
+{
+HX_HEADER(HxCodaGraphFilter);
+
+public:
+
+    /// How the vertex and edge selection are combined.
+    enum Combination
+    {
+        /// Keep the items kept by both selections.
+        COMBINE_INTERSECTION = 0,
+        /// Keep the items kept by either selection.
+        COMBINE_UNION = 1
+    };
+
+    virtual void update() override;
+    virtual void compute() override;
+
+    HxPortDoIt m_portDoIt;
+    PortCoda m_portCoda;
+    HxPortRadioBox m_portCombination;
+    QObject m_qtContext;
+};
\ No newline at end of file
@@ -19,8 +19,14 @@ HxCodaVertex::HxCodaVertex()
     : HxCompModule(HxSpreadSheet::getClassTypeId())
     , m_portDoIt(this, "action", tr("Action"), 1)
     , m_portCoda(this, "coda", tr("Coda"))
+    , m_portMaxRate(this, "maxRate", tr("Max. Rate [Hz]"), 1)
     , m_lastData()
 {
+    // Limit the number of exports per second, so that interactive edits
+    // do not make Coda reload the data on every single change.
+    m_portMaxRate.setMinMax(0.0f, 100.0f);
+    m_portMaxRate.setValue(2.0f);
+
     portData.addType(HxSpatialGraph::getClassTypeId());
     portData.addType(HxLabelAnalysis::getClassTypeId());
     portData.addType(HxUniformScalarField3::getClassTypeId());
@@ -55,6 +61,7 @@ void HxCodaVertex::update()
             if(coda->addVertexData(currentData))
             {
                 m_lastData = currentData;
+                coda->setExportRate(m_lastData, m_portMaxRate.getValue());
             }
             else
             {
@@ -63,6 +70,11 @@ void HxCodaVertex::update()
             }
         }
     }
+
+    if(m_portMaxRate.isNew() && m_lastData)
+    {
+        coda->setExportRate(m_lastData, m_portMaxRate.getValue());
+    }
 }
 
 
@@ -71,6 +83,6 @@ void HxCodaVertex::compute()
     if(m_lastData)
     {
         auto coda = coda::theCoda();
-        coda->writeVertexData(m_lastData.get());
+        coda->scheduleWriteVertexData(m_lastData.get());
     }
 }
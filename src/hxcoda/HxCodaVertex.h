@@ -3,6 +3,7 @@
 // ZIB
 #include <hxcore/HxCompModule.h>
 #include <hxcore/HxPortDoIt.h>
+#include <hxcore/HxPortFloatTextN.h>
 
 // Local
 #include <hxcoda/api.h>
@@ -27,5 +28,6 @@ public:
 
     HxPortDoIt m_portDoIt;
     PortCoda m_portCoda;
+    HxPortFloatTextN m_portMaxRate;
     McHandle<HxData> m_lastData;
 };
\ No newline at end of file
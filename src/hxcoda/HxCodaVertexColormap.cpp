@@ -1,4 +1,5 @@
 // STL
+#include <algorithm>
 
 // ZIB
 #include <hxcolor/HxColormap.h>
@@ -28,7 +29,12 @@ HxCodaVertexColormap::HxCodaVertexColormap()
     : HxCompModule(HxColormap::getClassTypeId())
     , m_portDoIt(this, "action", tr("Action"), 1)
     , m_portCoda(this, "coda", tr("Coda"))
+    , m_portOptions(this, "options", tr("Options"), 1)
+    , m_portMaxRate(this, "maxRate", tr("Max. Rate [Hz]"), 1)
     , m_lastData()
+    , m_qtContext()
+    , m_throttle(nullptr)
+    , m_pollTimer(nullptr)
 {
     portData.addType(HxSpatialGraph::getClassTypeId());
     portData.addType(HxUniformScalarField3::getClassTypeId());
@@ -36,15 +42,50 @@ HxCodaVertexColormap::HxCodaVertexColormap()
     portData.addType(HxLineRaycast::getClassTypeId());
     portData.addType(HxVolumeRender2::getClassTypeId());
     portData.setTightness(true);
+
+    m_portOptions.setLabel(OPTION_LIVE, tr("Live"));
+    m_portOptions.setValue(OPTION_LIVE, 0);
+
+    m_portMaxRate.setMinMax(0.0f, 100.0f);
+    m_portMaxRate.setValue(5.0f);
+
+    // The pushes are hash checked, so pushing an unchanged colormap 
+    // does not write anything.
+    m_throttle = new coda::ExportThrottle([this](){
+        coda::theCoda()->pushVertexColormap(portData);
+    }, &m_qtContext);
+    m_throttle->setMaxRate(m_portMaxRate.getValue());
+
+    m_pollTimer = new QTimer(&m_qtContext);
+    QObject::connect(m_pollTimer, &QTimer::timeout, &m_qtContext, [this](){
+        m_throttle->request();
+    });
 }
 
 
 HxCodaVertexColormap::~HxCodaVertexColormap()
-{}
+{
+    m_pollTimer->stop();
+}
 
 
 void HxCodaVertexColormap::update()
-{}
+{
+    const bool isLive = m_portOptions.getValue(OPTION_LIVE);
+    m_portMaxRate.setVisible(isLive);
+
+    if(m_portMaxRate.isNew())
+    {
+        m_throttle->setMaxRate(m_portMaxRate.getValue());
+    }
+
+    // A connected colormap notifies the module when it changes.
+    if(isLive && (portData.isNew() || m_portOptions.isNew()))
+    {
+        m_throttle->request();
+    }
+    updatePolling();
+}
 
 
 void HxCodaVertexColormap::compute()
@@ -52,3 +93,23 @@ void HxCodaVertexColormap::compute()
     auto coda = coda::theCoda();
     coda->writeVertexColormap(portData);
 }
+
+
+void HxCodaVertexColormap::updatePolling()
+{
+    const bool isLive = m_portOptions.getValue(OPTION_LIVE);
+    const bool isColormap = !!hxconnection_cast<HxColormap>(portData);
+    if(!isLive || isColormap || !portData.getSource())
+    {
+        m_pollTimer->stop();
+        return;
+    }
+
+    // Poll at the maximum rate, but at least once per second.
+    const double rate = std::max(1.0, static_cast<double>(m_portMaxRate.getValue()));
+    const int interval = static_cast<int>(1000.0/rate);
+    if(!m_pollTimer->isActive() || m_pollTimer->interval() != interval)
+    {
+        m_pollTimer->start(interval);
+    }
+}
\ No newline at end of file
@@ -1,11 +1,18 @@
 #pragma once
 
+// Qt
+#include <QObject>
+#include <QTimer>
+
 // ZIB
 #include <hxcore/HxCompModule.h>
 #include <hxcore/HxPortDoIt.h>
+#include <hxcore/HxPortFloatTextN.h>
+#include <hxcore/HxPortToggleList.h>
 
 // Local
 #include <hxcoda/api.h>
+#include <hxcoda/internal/ExportThrottle.h>
 #include <hxcoda/internal/PortCoda.h>
 
 
@@ -15,6 +22,11 @@
  * This module makes the colormap of the attached vertex data
  * (field, graph, colormap or renderer) available in Coda as 
  * vertex colormap.
+ * 
+ * In live mode, the colormap is pushed whenever it changes, limited to
+ * the maximum rate. Colormaps are observed directly. The colormap ports
+ * of renderers and fields do not notify this module, so they are polled.
+ * A push is skipped if the content of the colormap did not change.
  */
 class HXCODA_API HxCodaVertexColormap : public HxCompModule
 {
@@ -22,10 +34,30 @@ HX_HEADER(HxCodaVertexColormap);
 
 public:
 
+    /// The options of the module.
+    enum Option
+    {
+        /// Push the colormap whenever it changes.
+        OPTION_LIVE = 0
+    };
+
     virtual void update() override;
     virtual void compute() override;
 
     HxPortDoIt m_portDoIt;
     PortCoda m_portCoda;
+    HxPortToggleList m_portOptions;
+    HxPortFloatTextN m_portMaxRate;
     McHandle<HxData> m_lastData;
+    QObject m_qtContext;
+
+    /// Limits the rate of the live pushes.
+    coda::ExportThrottle* m_throttle;
+
+    /// Polls the colormap ports in live mode.
+    QTimer* m_pollTimer;
+
+protected:
+
+    void updatePolling();
 };
\ No newline at end of file
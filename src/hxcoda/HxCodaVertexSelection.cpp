@@ -1,4 +1,8 @@
 // STL
+#include <limits>
+
+// Qt
+#include <QDebug>
 
 // ZIB
 #include <hxspreadsheet/internal/HxSpreadSheet.h>
@@ -8,6 +12,7 @@
 // Local
 #include <hxcoda/HxCodaVertexSelection.h>
 #include <hxcoda/internal/Coda.h>
+#include <hxcoda/internal/SpreadSheetFilter.h>
 
 
 HX_INIT_CLASS(HxCodaVertexSelection, HxCompModule)
@@ -18,6 +23,7 @@ HxCodaVertexSelection::HxCodaVertexSelection()
     , m_portDoIt(this, "action", tr("Action"), 1)
     , m_portCoda(this, "coda", tr("Coda"))
     , m_qtContext()
+    , m_writtenSelection()
 {
     // Attach tight to the "dummy" data object since it should 
     // not be of real other use than being a dummy.
@@ -43,6 +49,11 @@ void HxCodaVertexSelection::compute()
     auto coda = coda::theCoda();
 
     const auto& vertexSelection = coda->vertexSelection();
+    if(vertexSelection.size() > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+    {
+        qWarning() << "The vertex selection exceeds the row limit of a spreadsheet.";
+        return;
+    }
     const int nrows = static_cast<int>(vertexSelection.size());
 
     // This module only outputs data. So we can just ignore all inputs.
@@ -52,18 +63,22 @@ void HxCodaVertexSelection::compute()
         filteredData = HxSpreadSheet::createInstance();
         filteredData->setLabel("CodaVertexSelection");
     }    
-    filteredData->clear();
-    filteredData->setNumRows(nrows);
-    
-    filteredData->addColumn("selected", HxSpreadSheet::Column::INT);
-    const int icol = filteredData->findColumn("selected", HxSpreadSheet::Column::INT);
 
-    // Populate the selection column.
-    for(int irow = 0; irow < nrows; ++irow)
+    // Reuse the spreadsheet and the selection column as long as the number
+    // of rows does not change. Otherwise, all rows are written again.
+    int icol = filteredData->findColumn("selected", HxSpreadSheet::Column::INT);
+    if(icol < 0 || filteredData->nRows() != nrows)
     {
-        const float selected = vertexSelection[irow] ? 1.0 : 0.0;
-        filteredData->column(icol)->setValue(irow, selected);
+        filteredData->clear();
+        filteredData->setNumRows(nrows);
+        filteredData->addColumn("selected", HxSpreadSheet::Column::INT);
+        icol = filteredData->findColumn("selected", HxSpreadSheet::Column::INT);
+        m_writtenSelection.clear();
     }
+
+    // Populate the selection column.
+    coda::updateSelectionColumn(filteredData->column(icol), vertexSelection, m_writtenSelection);
+    m_writtenSelection = vertexSelection;
     
     // Set the result.
     if(filteredData)
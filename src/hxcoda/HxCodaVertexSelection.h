@@ -1,5 +1,8 @@
 #pragma once
 
+// STL
+#include <vector>
+
 // Qt
 #include <QScopedPointer>
 #include <QObject>
@@ -36,5 +39,9 @@ public:
     HxPortDoIt m_portDoIt;
     PortCoda m_portCoda;
     QObject m_qtContext;
+
+    /// The selection written into the result, so that only the
+    /// changed rows are written when the selection changes.
+    std::vector<bool> m_writtenSelection;
 };
 
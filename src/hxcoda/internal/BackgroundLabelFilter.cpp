@@ -0,0 +1,233 @@
+// STL
+#include <algorithm>
+
+// Local
+#include <hxcoda/internal/BackgroundLabelFilter.h>
+#include <hxcoda/internal/LabelFilter.h>
+#include <hxcoda/internal/Parallel.h>
+
+
+namespace coda
+{
+
+
+BackgroundLabelFilter::BackgroundLabelFilter(QObject* parent)
+    : QObject(parent)
+    , m_worker()
+    , m_generation(0)
+    , m_running(false)
+    , m_input()
+    , m_index()
+    , m_fields()
+    , m_back(0)
+    , m_applied_selections()
+    , m_valid{false, false}
+    , m_selection()
+    , m_complete(false)
+{}
+
+
+BackgroundLabelFilter::~BackgroundLabelFilter()
+{
+    cancel();
+}
+
+
+/**
+ * Starts filtering *input* with the *selection* into the back field on the
+ * worker thread. A run in flight is cancelled first. Returns false if the
+ * primitive type of the input is not supported by the label kernels.
+ */
+bool BackgroundLabelFilter::start(HxUniformLabelField3* input, const std::vector<bool>& selection)
+{
+    if(!isLabelKernelType(input->primType()))
+    {
+        return false;
+    }
+
+    cancel();
+
+    if(m_input != input)
+    {
+        invalidate();
+        m_input = input;
+    }
+
+    // Configure the back field to match the input. Its voxels are only
+    // reused if the layout did not change.
+    McHandle<HxUniformLabelField3>& back = m_fields[m_back];
+    if(!back)
+    {
+        back = HxUniformLabelField3::createInstance();
+        m_valid[m_back] = false;
+    }
+
+    const McPrimType type = input->primType();
+    const auto dims = input->lattice().getDims();
+    const auto back_dims = back->lattice().getDims();
+    if(back->primType() != type || back_dims.nx != dims.nx || back_dims.ny != dims.ny || back_dims.nz != dims.nz)
+    {
+        back->lattice().setPrimType(type);
+        back->lattice().resize(dims);
+        m_valid[m_back] = false;
+    }
+    back->lattice().setBoundingBox(input->getBoundingBox());
+
+    // As in filter(), an empty selection is always applied fully.
+    const std::vector<bool>& previous = m_applied_selections[m_back];
+    const bool incremental = m_valid[m_back] && !selection.empty() && !previous.empty();
+
+    // The back field is only valid again if the run completes.
+    m_valid[m_back] = false;
+    m_selection = selection;
+    m_complete = false;
+    m_running = true;
+
+    const std::uint64_t generation = ++m_generation;
+    const std::int64_t nx = dims.nx;
+    const std::int64_t ny = dims.ny;
+    const std::int64_t nz = dims.nz;
+    const std::int64_t nbytes_slice = nx*ny*type.getSize();
+    const char* in = static_cast<const char*>(input->lattice().dataPtr());
+    char* out = static_cast<char*>(back->lattice().dataPtr());
+
+    m_worker = std::thread([this, generation, type, nx, ny, nz, nbytes_slice, in, out, incremental, previous]() {
+        if(incremental)
+        {
+            // Only the labels which changed since the back field has been
+            // filtered are written. Both steps stop after a slice or label
+            // once the run is cancelled, so cancel() does not block.
+            auto is_cancelled = [this, generation]() { return m_generation != generation; };
+            if(m_index.matches(type, nx, ny, nz) || m_index.build(in, type, nx, ny, nz, is_cancelled))
+            {
+                m_index.apply(out, m_selection, previous, is_cancelled);
+            }
+        }
+        else
+        {
+            const LabelFilterKernel kernel(type, m_selection);
+
+            // Check for cancellation after every slice.
+            parallelFor(0, nz, 1, [&](std::int64_t first, std::int64_t last) {
+                for(std::int64_t iz = first; iz < last && m_generation == generation; ++iz)
+                {
+                    const std::int64_t offset = iz*nbytes_slice;
+
+                    // An empty selection shows all labels, see filter().
+                    if(m_selection.empty())
+                    {
+                        std::copy_n(in + offset, nbytes_slice, out + offset);
+                    }
+                    else
+                    {
+                        kernel.apply(out + offset, in + offset, nx*ny);
+                    }
+                }
+            });
+        }
+
+        if(m_generation != generation)
+        {
+            return;
+        }
+
+        // Notify the main thread. The call is dropped if this object
+        // is destroyed in the meantime.
+        QMetaObject::invokeMethod(this, [this, generation]() {
+            if(m_generation == generation)
+            {
+                m_running = false;
+                m_complete = true;
+                m_applied_selections[m_back] = m_selection;
+                m_valid[m_back] = true;
+                emit finished();
+            }
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+
+/**
+ * Cancels the run in flight and waits for the worker to stop, which
+ * happens after at most one slice or, in an incremental update, one
+ * label per thread.
+ */
+void BackgroundLabelFilter::cancel()
+{
+    ++m_generation;
+    join();
+    m_running = false;
+    m_complete = false;
+}
+
+
+/**
+ * Forgets the voxel index and the selections of both fields, e.g. because
+ * the data of the input changed or the front field has been modified.
+ * The fields are kept, so that their memory is reused.
+ */
+void BackgroundLabelFilter::invalidate()
+{
+    cancel();
+    m_index.clear();
+    for(int ifield = 0; ifield < 2; ++ifield)
+    {
+        m_applied_selections[ifield].clear();
+        m_valid[ifield] = false;
+    }
+}
+
+
+/**
+ * Like invalidate(), but also releases both fields.
+ */
+void BackgroundLabelFilter::clear()
+{
+    invalidate();
+    m_input.release();
+    m_fields[0].release();
+    m_fields[1].release();
+}
+
+
+bool BackgroundLabelFilter::isRunning() const
+{
+    return m_running;
+}
+
+
+/**
+ * Returns the completed back field, which becomes the front field, or
+ * nullptr if no run has completed. The previous front field becomes the
+ * back field of the next run, so it must no longer be shown as result.
+ *
+ * This must be called on the main thread, usually in response to finished().
+ */
+HxUniformLabelField3* BackgroundLabelFilter::takeResult()
+{
+    if(!m_complete)
+    {
+        return nullptr;
+    }
+    join();
+
+    HxUniformLabelField3* result = m_fields[m_back];
+    result->touchMinMax();
+
+    m_back = 1 - m_back;
+    m_complete = false;
+    return result;
+}
+
+
+void BackgroundLabelFilter::join()
+{
+    if(m_worker.joinable())
+    {
+        m_worker.join();
+    }
+}
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+// STL
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Qt
+#include <QObject>
+
+// ZIB
+#include <mclib/McHandle.h>
+#include <hxfield/HxUniformLabelField3.h>
+
+// Local
+#include <hxcoda/internal/LabelIndex.h>
+
+
+namespace coda
+{
+
+
+/**
+ * @brief The BackgroundLabelFilter class
+ *
+ * Filters a label field on a worker thread, so that the GUI does not block
+ * and the viewers keep showing the last complete result.
+ *
+ * The filter is double buffered with two result fields. The front field is
+ * shown as the result of the module while the worker fills the back field.
+ * When a run is complete, finished() is emitted on the main thread and the
+ * back field can be taken with takeResult(), which makes it the new front
+ * field. No voxels are copied on the main thread.
+ *
+ * Each field remembers the selection it has been filtered with, so that a
+ * run only updates the voxels of the labels which changed since then, see
+ * LabelIndex. Starting a new run cancels the run in flight, so only the
+ * newest selection is completed.
+ */
+class BackgroundLabelFilter : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit BackgroundLabelFilter(QObject* parent = nullptr);
+    virtual ~BackgroundLabelFilter();
+
+    bool start(HxUniformLabelField3* input, const std::vector<bool>& selection);
+    void cancel();
+    void invalidate();
+    void clear();
+
+    bool isRunning() const;
+    HxUniformLabelField3* takeResult();
+
+signals:
+
+    void finished();
+
+private:
+
+    void join();
+
+private:
+
+    /// The worker thread of the current run.
+    std::thread m_worker;
+
+    /// Incremented for every run. A run is cancelled as soon as the
+    /// generation changes.
+    std::atomic<std::uint64_t> m_generation;
+
+    /// True while the worker of the current generation is running.
+    std::atomic<bool> m_running;
+
+    /// The input of the current run and its per-label voxel index, which
+    /// is built by the worker when it is needed for the first time.
+    McHandle<HxUniformLabelField3> m_input;
+    LabelIndex m_index;
+
+    /// The front and back result fields, indexed by *m_back*.
+    McHandle<HxUniformLabelField3> m_fields[2];
+    int m_back;
+
+    /// The selection each field has been filtered with and whether the
+    /// field still contains the input filtered with it.
+    std::vector<bool> m_applied_selections[2];
+    bool m_valid[2];
+
+    /// The selection of the current run.
+    std::vector<bool> m_selection;
+
+    /// True if the back field holds a complete result, which has
+    /// not been taken yet.
+    bool m_complete;
+};
+
+
+} // namespace coda
\ No newline at end of file
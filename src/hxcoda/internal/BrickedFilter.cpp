@@ -0,0 +1,347 @@
+// STL
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+// Qt
+#include <QDebug>
+#include <QFile>
+#include <QRegularExpression>
+
+// Local
+#include <hxcoda/internal/BrickedFilter.h>
+#include <hxcoda/internal/LabelFilter.h>
+#include <hxcoda/internal/Parallel.h>
+
+
+namespace coda
+{
+
+
+/**
+ * Returns a pointer to *nbytes* bytes of raw voxel data starting at the
+ * byte *offset*. The data is either read into *buffer* or, if the volume
+ * is resident, returned directly. Returns nullptr on failure.
+ */
+typedef std::function<
+    const void*(std::vector<char>& buffer, std::int64_t offset, std::int64_t nbytes)
+> BrickReader;
+
+
+/**
+ * Returns the AmiraMesh name of the primitive type.
+ */
+static QString amiraMeshType(McPrimType type)
+{
+    if(type == McPrimType::MC_UINT8)
+    {
+        return "byte";
+    }
+    if(type == McPrimType::MC_UINT16)
+    {
+        return "ushort";
+    }
+    return "int";
+}
+
+
+bool readAmiraMeshHeader(const QString& path, LabelVolumeInfo& info)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    // The header is plain text and followed by the binary data sections,
+    // so reading the first few kilobytes is enough.
+    const QByteArray raw_header = file.read(64*1024);
+    if(!raw_header.startsWith("# AmiraMesh BINARY-LITTLE-ENDIAN"))
+    {
+        return false;
+    }
+
+    const QString header = QString::fromLatin1(raw_header);
+
+    const QRegularExpression re_dims("define\\s+Lattice\\s+(\\d+)\\s+(\\d+)\\s+(\\d+)");
+    const QRegularExpression re_lattice("Lattice\\s*\\{\\s*(\\w+)\\s+\\w+\\s*\\}\\s*@(\\d+)(\\S*)");
+    const QRegularExpression re_bbox(
+        "BoundingBox\\s+(\\S+)\\s+(\\S+)\\s+(\\S+)\\s+(\\S+)\\s+(\\S+)\\s+([^\\s,]+)"
+    );
+
+    const auto match_dims = re_dims.match(header);
+    const auto match_lattice = re_lattice.match(header);
+    if(!match_dims.hasMatch() || !match_lattice.hasMatch())
+    {
+        return false;
+    }
+
+    // Compressed data sections, e.g. "@1(HxByteRLE,1234)", cannot be
+    // accessed brick by brick.
+    if(!match_lattice.captured(3).isEmpty())
+    {
+        return false;
+    }
+
+    const QString type = match_lattice.captured(1);
+    if(type == "byte")
+    {
+        info.type = McPrimType::MC_UINT8;
+    }
+    else if(type == "ushort")
+    {
+        info.type = McPrimType::MC_UINT16;
+    }
+    else if(type == "int")
+    {
+        info.type = McPrimType::MC_INT32;
+    }
+    else
+    {
+        return false;
+    }
+
+    for(int i = 0; i < 3; ++i)
+    {
+        info.dims[i] = match_dims.captured(i + 1).toLongLong();
+    }
+
+    // An empty lattice has no rows which could be split into bricks.
+    if(info.dims[0]*info.dims[1]*info.dims[2] <= 0)
+    {
+        return false;
+    }
+
+    const auto match_bbox = re_bbox.match(header);
+    for(int i = 0; i < 6; ++i)
+    {
+        info.bounding_box[i] = match_bbox.hasMatch()
+            ? match_bbox.captured(i + 1).toFloat()
+            : static_cast<float>((i % 2)*(info.dims[i/2] - 1));
+    }
+
+    // The data section of the lattice starts after its marker "@N" on a
+    // line of its own, which follows the declarations. The header is Latin-1,
+    // so the indices in the string are byte offsets.
+    const QByteArray marker = "\n@" + match_lattice.captured(2).toLatin1() + "\n";
+    int ifrom = match_lattice.capturedEnd(0);
+    const int ifollows = raw_header.indexOf("# Data section follows", ifrom);
+    if(ifollows >= 0)
+    {
+        ifrom = ifollows;
+    }
+
+    // The offset of a section behind other binary sections is unknown,
+    // so the lattice must be the first section.
+    const int idata = raw_header.indexOf(marker, ifrom);
+    if(idata < 0 || idata != raw_header.indexOf("\n@", ifrom))
+    {
+        return false;
+    }
+    info.data_offset = idata + marker.size();
+    return true;
+}
+
+
+/**
+ * Writes the AmiraMesh header for the label volume and allocates the
+ * data section. Returns the offset of the data section or -1 on failure.
+ */
+static std::int64_t writeAmiraMeshHeader(const QString& path, const LabelVolumeInfo& info)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return -1;
+    }
+
+    const QString header = QString(
+        "# AmiraMesh BINARY-LITTLE-ENDIAN 2.1\n"
+        "\n"
+        "define Lattice %1 %2 %3\n"
+        "\n"
+        "Parameters {\n"
+        "    BoundingBox %4 %5 %6 %7 %8 %9,\n"
+        "    CoordType \"uniform\"\n"
+        "}\n"
+        "\n"
+        "Lattice { %10 Labels } @1\n"
+        "\n"
+        "# Data section follows\n"
+        "@1\n"
+    )
+        .arg(info.dims[0]).arg(info.dims[1]).arg(info.dims[2])
+        .arg(info.bounding_box[0]).arg(info.bounding_box[1])
+        .arg(info.bounding_box[2]).arg(info.bounding_box[3])
+        .arg(info.bounding_box[4]).arg(info.bounding_box[5])
+        .arg(amiraMeshType(info.type));
+
+    const QByteArray raw_header = header.toLatin1();
+    if(file.write(raw_header) != raw_header.size())
+    {
+        return -1;
+    }
+
+    // Allocate the data section, so that the workers can write their
+    // bricks in any order.
+    const std::int64_t nbytes = info.dims[0]*info.dims[1]*info.dims[2]*info.type.getSize();
+    if(!file.resize(raw_header.size() + nbytes + 1) || !file.seek(raw_header.size() + nbytes))
+    {
+        return -1;
+    }
+    file.write("\n", 1);
+    return raw_header.size();
+}
+
+
+static bool filterBrickedRows(
+    const QString& output_path,
+    const LabelVolumeInfo& info,
+    const BrickReader& read,
+    const std::vector<bool>& selection,
+    std::int64_t max_brick_bytes
+) {
+    // The size of a brick is computed from the size of a row.
+    if(info.dims[0]*info.dims[1]*info.dims[2] <= 0)
+    {
+        qWarning() << "The label field is empty.";
+        return false;
+    }
+
+    const std::int64_t output_offset = writeAmiraMeshHeader(output_path, info);
+    if(output_offset < 0)
+    {
+        qWarning() << "Failed to create the file" << output_path;
+        return false;
+    }
+
+    // A brick consists of consecutive rows, which are contiguous in memory
+    // and in the file, also across slice boundaries.
+    const std::int64_t voxel_bytes = info.type.getSize();
+    const std::int64_t row_voxels = info.dims[0];
+    const std::int64_t nrows = info.dims[1]*info.dims[2];
+    const std::int64_t brick_rows = std::max<std::int64_t>(1, max_brick_bytes/(row_voxels*voxel_bytes));
+    const std::int64_t nbricks = (nrows + brick_rows - 1)/brick_rows;
+
+    const LabelFilterKernel kernel(info.type, selection);
+    std::atomic<bool> success(true);
+
+    parallelForChunks(nbricks, [&](std::int64_t ibrick) {
+        if(!success)
+        {
+            return;
+        }
+
+        const std::int64_t first_row = ibrick*brick_rows;
+        const std::int64_t last_row = std::min(nrows, first_row + brick_rows);
+        const std::int64_t nvoxels = (last_row - first_row)*row_voxels;
+        const std::int64_t offset = first_row*row_voxels*voxel_bytes;
+        const std::int64_t nbytes = nvoxels*voxel_bytes;
+
+        std::vector<char> input_brick;
+        std::vector<char> output_brick(nbytes);
+
+        const void* input = read(input_brick, offset, nbytes);
+        if(input == nullptr)
+        {
+            success = false;
+            return;
+        }
+
+        // An empty selection shows all labels, see filter().
+        if(selection.empty())
+        {
+            std::copy_n(static_cast<const char*>(input), nbytes, output_brick.data());
+        }
+        else
+        {
+            kernel.apply(output_brick.data(), input, nvoxels);
+        }
+
+        // Each worker uses its own file handle, the bricks do not overlap.
+        QFile file(output_path);
+        if(
+            !file.open(QIODevice::ReadWrite)
+            || !file.seek(output_offset + offset)
+            || file.write(output_brick.data(), nbytes) != nbytes
+        ) {
+            success = false;
+        }
+    });
+
+    if(!success)
+    {
+        qWarning() << "Failed to write the filtered bricks to" << output_path;
+    }
+    return success;
+}
+
+
+bool filterBricked(
+    const QString& output_path,
+    const QString& input_path,
+    const std::vector<bool>& selection,
+    std::int64_t max_brick_bytes
+) {
+    LabelVolumeInfo info;
+    if(!readAmiraMeshHeader(input_path, info))
+    {
+        qWarning() << "The file" << input_path << "is not an uncompressed AmiraMesh label volume.";
+        return false;
+    }
+
+    const BrickReader read = [&](std::vector<char>& buffer, std::int64_t offset, std::int64_t nbytes) -> const void* {
+        buffer.resize(nbytes);
+
+        QFile file(input_path);
+        if(
+            !file.open(QIODevice::ReadOnly)
+            || !file.seek(info.data_offset + offset)
+            || file.read(buffer.data(), nbytes) != nbytes
+        ) {
+            return nullptr;
+        }
+        return buffer.data();
+    };
+    return filterBrickedRows(output_path, info, read, selection, max_brick_bytes);
+}
+
+
+bool filterBricked(
+    const QString& output_path,
+    HxUniformLabelField3* input,
+    const std::vector<bool>& selection,
+    std::int64_t max_brick_bytes
+) {
+    if(!isLabelKernelType(input->primType()))
+    {
+        qWarning() << "The label field must be of type uint8, uint16 or int32.";
+        return false;
+    }
+
+    const auto dims = input->lattice().getDims();
+    const McBox3f bounding_box = input->getBoundingBox();
+
+    LabelVolumeInfo info;
+    info.dims[0] = dims.nx;
+    info.dims[1] = dims.ny;
+    info.dims[2] = dims.nz;
+    info.type = input->primType();
+    info.bounding_box[0] = bounding_box.getMin().x;
+    info.bounding_box[1] = bounding_box.getMax().x;
+    info.bounding_box[2] = bounding_box.getMin().y;
+    info.bounding_box[3] = bounding_box.getMax().y;
+    info.bounding_box[4] = bounding_box.getMin().z;
+    info.bounding_box[5] = bounding_box.getMax().z;
+    info.data_offset = 0;
+
+    // The voxels are already in memory, so no copy is needed.
+    const char* data = static_cast<const char*>(input->lattice().dataPtr());
+    const BrickReader read = [data](std::vector<char>&, std::int64_t offset, std::int64_t) -> const void* {
+        return data + offset;
+    };
+    return filterBrickedRows(output_path, info, read, selection, max_brick_bytes);
+}
+
+
+} // namespace coda
\ No newline at end of file
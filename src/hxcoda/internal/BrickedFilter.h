@@ -0,0 +1,77 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// Qt
+#include <QString>
+
+// ZIB
+#include <mclib/McPrimType.h>
+#include <hxfield/HxUniformLabelField3.h>
+
+
+namespace coda
+{
+
+
+/**
+ * The geometry and layout of a label volume stored as uncompressed
+ * little-endian AmiraMesh file.
+ */
+struct LabelVolumeInfo
+{
+    /// The number of voxels along each axis.
+    std::int64_t dims[3];
+
+    /// The primitive type of the labels.
+    McPrimType type;
+
+    /// The bounding box ``xmin xmax ymin ymax zmin zmax``.
+    float bounding_box[6];
+
+    /// The offset of the raw voxel data in the file in bytes.
+    std::int64_t data_offset;
+};
+
+
+/**
+ * Reads the header of an AmiraMesh label volume. Only uncompressed binary
+ * little-endian files with a ``byte``, ``ushort`` or ``int`` lattice can be
+ * streamed, for all other files false is returned.
+ */
+bool readAmiraMeshHeader(const QString& path, LabelVolumeInfo& info);
+
+
+/**
+ * Filters the label volume stored in the AmiraMesh file *input_path* and
+ * writes the result to the AmiraMesh file *output_path*.
+ *
+ * The volume is streamed brick by brick. A brick consists of consecutive
+ * rows of voxels and occupies at most *max_brick_bytes*. The bricks are
+ * filtered by parallel workers, so the memory consumption is bounded by
+ * a few bricks per worker regardless of the volume size.
+ */
+bool filterBricked(
+    const QString& output_path,
+    const QString& input_path,
+    const std::vector<bool>& selection,
+    std::int64_t max_brick_bytes = 64*1024*1024
+);
+
+
+/**
+ * Filters the resident label field *input* brick by brick and writes the
+ * result to the AmiraMesh file *output_path* without allocating a filtered
+ * copy in memory.
+ */
+bool filterBricked(
+    const QString& output_path,
+    HxUniformLabelField3* input,
+    const std::vector<bool>& selection,
+    std::int64_t max_brick_bytes = 64*1024*1024
+);
+
+
+} // namespace coda
\ No newline at end of file
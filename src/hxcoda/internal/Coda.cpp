@@ -1,12 +1,22 @@
 // STL
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <string>
 
 // Qt
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QDebug>
 #include <QFileSystemWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
 
 // ZIB
 #include <hxcolor/HxColormap.h>
@@ -28,6 +38,12 @@
 
 // Local
 #include <hxcoda/internal/Coda.h>
+#include <hxcoda/internal/GraphSelection.h>
+#include <hxcoda/internal/HexColor.h>
+#include <hxcoda/internal/ItemColors.h>
+#include <hxcoda/internal/LabelFilter.h>
+#include <hxcoda/internal/SelectionCsv.h>
+#include <hxcoda/internal/Subgraph.h>
 
 
 // XXX: Needs to be included last because Inventor included
@@ -124,6 +140,41 @@ static bool saveAsNpy(QString path, HxObject* data)
 }
 
 
+/**
+ * FNV-1a hash of the bytes *bytes*.
+ */
+static std::uint64_t hashBytes(const QByteArray& bytes)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for(const char byte: bytes)
+    {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+
+/**
+ * Replaces the file at *path* atomically with the *bytes*, so that Coda 
+ * never reads a partially written file.
+ */
+static bool saveBytes(const QString& path, const QByteArray& bytes)
+{
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    if(file.write(bytes) != bytes.size())
+    {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+
 Coda::Coda(QObject* parent)
     : QObject(parent)
     , m_data_directory(temporaryDirectoryTemplatePath())
@@ -132,14 +183,28 @@ Coda::Coda(QObject* parent)
     , m_edge_data_to_path()
     , m_vertex_data_to_path()
     , m_path_to_data()
+    , m_path_to_throttle()
+    , m_graph_indices()
+    , m_last_graph_stamp(0)
+    , m_graph_parents()
+    , m_propagation_graph()
+    , m_propagation(PROPAGATE_NONE)
+    , m_expansion_graph()
+    , m_expansion(EXPAND_NONE)
+    , m_expansion_hops(1)
     , m_coda_vertex_selection()
-    , m_coda_vertex_selection_csv(nullptr)
+    , m_coda_vertex_selection_seed()
+    , m_coda_vertex_table_selections()
     , m_coda_vertex_selection_timer(nullptr)
     , m_coda_edge_selection()
-    , m_coda_edge_selection_csv(nullptr)
+    , m_coda_edge_selection_seed()
+    , m_coda_edge_table_selections()
     , m_coda_edge_selection_timer(nullptr)
     , m_coda_vertex_colormap(nullptr)
     , m_coda_edge_colormap(nullptr)
+    , m_amira_vertex_colormap_hash(0)
+    , m_amira_edge_colormap_hash(0)
+    , m_is_changing_attributes(false)
 {
     m_process = new CodaProcess(m_data_directory.path());
 
@@ -171,6 +236,16 @@ Coda::Coda(QObject* parent)
         readEdgeColormap();
         m_watcher->addPath(edgeColormapPath());
     }
+    if(QFileInfo(vertexColorsPath()).exists())
+    {
+        readVertexColormap();
+        m_watcher->addPath(vertexColorsPath());
+    }
+    if(QFileInfo(edgeColorsPath()).exists())
+    {
+        readEdgeColormap();
+        m_watcher->addPath(edgeColorsPath());
+    }
 
     connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &Coda::on_watcher_fileChanged);
     connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &Coda::on_watcher_directoryChanged);
@@ -222,8 +297,12 @@ bool Coda::addVertexData(HxData* data)
 
     m_vertex_data_to_path[data] = path;
     m_path_to_data[path] = data;
+    m_path_to_throttle[path] = new ExportThrottle([this, data](){
+        this->writeVertexData(data);
+    }, this);
 
-    writeVertexData(data);
+    // The data is written once Coda requests it.
+    writeManifest();
     return true;
 }
 
@@ -231,15 +310,18 @@ bool Coda::addVertexData(HxData* data)
 void Coda::removeVertexData(HxData* data)
 {
     // Nothing to do since the data is not synchronized.
-    if(!m_vertex_data_to_path.remove(data))
+    if(!m_vertex_data_to_path.contains(data))
     {
         return;
     }
 
     QString path = m_vertex_data_to_path.take(data);
     m_path_to_data.remove(path);
+    m_exported_paths.remove(path);
+    delete m_path_to_throttle.take(path);
 
     QFile::remove(path);
+    writeManifest();
     return;
 }
 
@@ -254,6 +336,14 @@ void Coda::writeVertexData(HxData* data)
 
     const QString path = m_vertex_data_to_path[data];
 
+    // Coda did not request the data yet, so only its description
+    // in the manifest is updated.
+    if(!m_exported_paths.contains(path))
+    {
+        writeManifest();
+        return;
+    }
+
     // spreadsheet?
     if(HxSpreadSheet* spreadsheet = dynamic_cast<HxSpreadSheet*>(data))
     {
@@ -284,6 +374,26 @@ void Coda::writeVertexData(HxData* data)
 }
 
 
+void Coda::scheduleWriteVertexData(HxData* data)
+{
+    // Nothing to do. The data object has not been added to Coda yet.
+    if(!m_vertex_data_to_path.contains(data))
+    {
+        return;
+    }
+
+    // The colors imported from Coda and the selection attributes
+    // are not sent back.
+    if(m_is_changing_attributes)
+    {
+        return;
+    }
+
+    const QString path = m_vertex_data_to_path[data];
+    m_path_to_throttle[path]->request();
+}
+
+
 bool Coda::addEdgeData(HxData* data)
 {    
     // The data object is already synchronized.
@@ -308,8 +418,12 @@ bool Coda::addEdgeData(HxData* data)
 
     m_edge_data_to_path[data] = path;
     m_path_to_data[path] = data;
+    m_path_to_throttle[path] = new ExportThrottle([this, data](){
+        this->writeEdgeData(data);
+    }, this);
 
-    writeEdgeData(data);
+    // The data is written once Coda requests it.
+    writeManifest();
     return true;
 }
 
@@ -317,15 +431,18 @@ bool Coda::addEdgeData(HxData* data)
 void Coda::removeEdgeData(HxData* data)
 {
     // Nothing to do since the data is not synchronized.
-    if(!m_edge_data_to_path.remove(data))
+    if(!m_edge_data_to_path.contains(data))
     {
         return;
     }
 
     QString path = m_edge_data_to_path.take(data);
     m_path_to_data.remove(path);
+    m_exported_paths.remove(path);
+    delete m_path_to_throttle.take(path);
 
     QFile::remove(path);
+    writeManifest();
     return;
 }
 
@@ -340,6 +457,14 @@ void Coda::writeEdgeData(HxData* data)
 
     const QString path = m_edge_data_to_path[data];
 
+    // Coda did not request the data yet, so only its description
+    // in the manifest is updated.
+    if(!m_exported_paths.contains(path))
+    {
+        writeManifest();
+        return;
+    }
+
     // spreadsheet?
     if(HxSpreadSheet* spreadsheet = dynamic_cast<HxSpreadSheet*>(data))
     {
@@ -370,6 +495,161 @@ void Coda::writeEdgeData(HxData* data)
 }
 
 
+void Coda::scheduleWriteEdgeData(HxData* data)
+{
+    // Nothing to do. The data object has not been added to Coda yet.
+    if(!m_edge_data_to_path.contains(data))
+    {
+        return;
+    }
+
+    // The colors imported from Coda and the selection attributes
+    // are not sent back.
+    if(m_is_changing_attributes)
+    {
+        return;
+    }
+
+    const QString path = m_edge_data_to_path[data];
+    m_path_to_throttle[path]->request();
+}
+
+
+void Coda::setExportRate(HxData* data, double rate)
+{
+    // A data object may be synchronized as vertex and edge data,
+    // e.g. a spatialgraph, so update both throttles.
+    if(m_vertex_data_to_path.contains(data))
+    {
+        m_path_to_throttle[m_vertex_data_to_path[data]]->setMaxRate(rate);
+    }
+    if(m_edge_data_to_path.contains(data))
+    {
+        m_path_to_throttle[m_edge_data_to_path[data]]->setMaxRate(rate);
+    }
+}
+
+
+QString Coda::manifestPath()
+{
+    return QDir(m_data_directory.path()).absoluteFilePath("amira_manifest.json");
+}
+
+
+/**
+ * Describes the data object *data* in the manifest *entry* without
+ * serializing it. The row count is -1 if it is only known after 
+ * the export.
+ */
+static void describeData(QJsonObject& entry, HxData* data, bool is_vertex)
+{
+    qint64 nrows = -1;
+    QJsonArray columns;
+
+    if(HxSpreadSheet* spreadsheet = dynamic_cast<HxSpreadSheet*>(data))
+    {
+        nrows = spreadsheet->nRows();
+        for(int icol = 0; icol < spreadsheet->nColumns(); ++icol)
+        {
+            columns.append(QString::fromLocal8Bit(spreadsheet->column(icol)->name.getString()));
+        }
+    }
+    else if(HxSpatialGraph* graph = dynamic_cast<HxSpatialGraph*>(data))
+    {
+        const HxSpatialGraph::ItemType type = is_vertex ? HxSpatialGraph::VERTEX : HxSpatialGraph::EDGE;
+        nrows = is_vertex ? graph->getNumVertices() : graph->getNumEdges();
+        for(int iattribute = 0; iattribute < graph->numAttributes(type); ++iattribute)
+        {
+            columns.append(QString::fromLocal8Bit(graph->attribute(type, iattribute)->getName()));
+        }
+    }
+    else if(HxUniformScalarField3* field = dynamic_cast<HxUniformScalarField3*>(data))
+    {
+        const auto& dims = field->lattice().getDims();
+        nrows = static_cast<qint64>(dims.nx)*dims.ny*dims.nz;
+    }
+    else if(HxUniformVectorField3* field = dynamic_cast<HxUniformVectorField3*>(data))
+    {
+        const auto& dims = field->lattice().getDims();
+        nrows = static_cast<qint64>(dims.nx)*dims.ny*dims.nz;
+    }
+
+    entry["name"] = data->getLabel();
+    entry["items"] = is_vertex ? "vertex" : "edge";
+    entry["rows"] = nrows;
+    entry["columns"] = columns;
+}
+
+
+/**
+ * Publishes the lightweight description of all synchronized data 
+ * objects, so that Coda can list them without loading them.
+ */
+void Coda::writeManifest()
+{
+    QJsonArray datasets;
+    for(int ikind = 0; ikind < 2; ++ikind)
+    {
+        const bool is_vertex = ikind == 0;
+        const QMap<HxData*, QString>& data_to_path = is_vertex ? m_vertex_data_to_path : m_edge_data_to_path;
+        for(auto it = data_to_path.constBegin(); it != data_to_path.constEnd(); ++it)
+        {
+            QJsonObject entry;
+            describeData(entry, it.key(), is_vertex);
+            entry["file"] = QFileInfo(it.value()).fileName();
+            entry["exported"] = m_exported_paths.contains(it.value());
+            datasets.append(entry);
+        }
+    }
+
+    QJsonObject manifest;
+    manifest["datasets"] = datasets;
+    if(!saveBytes(manifestPath(), QJsonDocument(manifest).toJson()))
+    {
+        qWarning() << "Could not write the manifest.";
+    }
+}
+
+
+/**
+ * Writes the data objects Coda requested with a ``<file name>.request``
+ * file. Once exported, a data object is kept up to date.
+ */
+void Coda::readExportRequests()
+{
+    const QDir directory(m_data_directory.path());
+    const QStringList requests = directory.entryList(QStringList() << "*.request", QDir::Files);
+    if(requests.isEmpty())
+    {
+        return;
+    }
+
+    for(const QString& request: requests)
+    {
+        QFile::remove(directory.absoluteFilePath(request));
+
+        const QString path = directory.absoluteFilePath(request.left(request.size() - 8));
+        HxData* data = m_path_to_data.value(path).get();
+        if(!data)
+        {
+            continue;
+        }
+
+        // Also write the data again if Coda requests it a second time.
+        m_exported_paths.insert(path);
+        if(m_vertex_data_to_path.value(data) == path)
+        {
+            writeVertexData(data);
+        }
+        else
+        {
+            writeEdgeData(data);
+        }
+    }
+    writeManifest();
+}
+
+
 QString Coda::vertexSelectionPath()
 {
     return QDir(m_data_directory.path()).absoluteFilePath("coda_vertex_selection.csv");
@@ -378,10 +658,87 @@ QString Coda::vertexSelectionPath()
 
 void Coda::readVertexSelection()
 {
+    std::vector<bool> selection;
+    TableSelections table_selections;
     loadCodaSelection(
-        m_coda_vertex_selection, m_coda_vertex_selection_csv, vertexSelectionPath()
+        selection, table_selections, vertexSelectionPath()
     );
+
+    // Nothing to do if the file did not change the selection, e.g.
+    // after our own write in writeVertexSelection().
+    if(selection == m_coda_vertex_selection && table_selections == m_coda_vertex_table_selections)
+    {
+        return;
+    }
+
+    // Expand the new selection and send the expanded one back to Coda.
+    m_coda_vertex_selection_seed = selection;
+    if(expandVertexSelection(selection))
+    {
+        if(selection == m_coda_vertex_selection && table_selections == m_coda_vertex_table_selections)
+        {
+            return;
+        }
+        saveCodaSelection(selection, table_selections, vertexSelectionPath());
+    }
+
+    m_coda_vertex_selection.swap(selection);
+    m_coda_vertex_table_selections.swap(table_selections);
     emit vertexSelectionChanged();
+    propagateVertexSelection();
+}
+
+
+/**
+ * Maps the *selection* made on a filtered descendant of the spatialgraph
+ * *parent* back to the parent. Cascaded filters are followed up to
+ * *depth* levels.
+ */
+bool Coda::selectionFromChild(
+    std::vector<bool>& parent_selection,
+    HxSpatialGraph* parent,
+    HxSpatialGraph::ItemType type,
+    const std::vector<bool>& selection,
+    int depth
+) const {
+    if(depth <= 0)
+    {
+        return false;
+    }
+
+    const std::int64_t nparent = type == HxSpatialGraph::VERTEX ? parent->getNumVertices() : parent->getNumEdges();
+    for(auto it = m_graph_parents.constBegin(); it != m_graph_parents.constEnd(); ++it)
+    {
+        // Children which have been deleted everywhere else are 
+        // no longer exported.
+        HxSpatialGraph* child = it->child;
+        if(it->parent != parent || child == parent || isOrphaned(child))
+        {
+            continue;
+        }
+
+        const std::int64_t nchild = type == HxSpatialGraph::VERTEX ? child->getNumVertices() : child->getNumEdges();
+
+        // The selection has been made on the child.
+        if(nchild == static_cast<std::int64_t>(selection.size()))
+        {
+            if(mapToParent(parent_selection, child, type, selection, nparent))
+            {
+                return true;
+            }
+            continue;
+        }
+
+        // The selection has been made on a descendant of the child.
+        std::vector<bool> child_selection;
+        if(
+            selectionFromChild(child_selection, child, type, selection, depth - 1)
+            && mapToParent(parent_selection, child, type, child_selection, nparent)
+        ) {
+            return true;
+        }
+    }
+    return false;
 }
 
 
@@ -391,6 +748,61 @@ const std::vector<bool>& Coda::vertexSelection() const
 }
 
 
+/**
+ * Returns the vertex selection in the index space of the spatialgraph 
+ * *graph*. If the selection has been made on a filtered child of the graph, 
+ * it is mapped back using the original indices of the child.
+ */
+std::vector<bool> Coda::vertexSelection(HxSpatialGraph* graph) const
+{
+    std::vector<bool> selection;
+    if(
+        graph->getNumVertices() != static_cast<std::int64_t>(m_coda_vertex_selection.size())
+        && selectionFromChild(selection, graph, HxSpatialGraph::VERTEX, m_coda_vertex_selection)
+    ) {
+        return selection;
+    }
+    return m_coda_vertex_selection;
+}
+
+
+/**
+ * Returns the selections Coda made on individual tables of a spreadsheet
+ * for the vertices. The other tables use the common vertex selection.
+ */
+const TableSelections& Coda::vertexTableSelections() const
+{
+    return m_coda_vertex_table_selections;
+}
+
+
+/**
+ * Replaces the vertex selection and writes it back to Coda, 
+ * using the same file Coda uses to share its selection.
+ */
+void Coda::writeVertexSelection(const std::vector<bool>& selection)
+{
+    m_coda_vertex_selection_seed = selection;
+    storeVertexSelection(selection);
+}
+
+
+void Coda::storeVertexSelection(const std::vector<bool>& selection)
+{
+    if(selection == m_coda_vertex_selection)
+    {
+        return;
+    }
+
+    m_coda_vertex_selection = selection;
+    if(!saveCodaSelection(m_coda_vertex_selection, m_coda_vertex_table_selections, vertexSelectionPath()))
+    {
+        qWarning() << "Could not write the vertex selection.";
+    }
+    emit vertexSelectionChanged();
+}
+
+
 QString Coda::edgeSelectionPath()
 {
     return QDir(m_data_directory.path()).absoluteFilePath("coda_edge_selection.csv");
@@ -399,10 +811,34 @@ QString Coda::edgeSelectionPath()
 
 void Coda::readEdgeSelection()
 {
+    std::vector<bool> selection;
+    TableSelections table_selections;
     loadCodaSelection(
-        m_coda_edge_selection, m_coda_edge_selection_csv, edgeSelectionPath()
+        selection, table_selections, edgeSelectionPath()
     );
+
+    // Nothing to do if the file did not change the selection, e.g.
+    // after our own write in writeEdgeSelection().
+    if(selection == m_coda_edge_selection && table_selections == m_coda_edge_table_selections)
+    {
+        return;
+    }
+
+    // Expand the new selection and send the expanded one back to Coda.
+    m_coda_edge_selection_seed = selection;
+    if(expandEdgeSelection(selection))
+    {
+        if(selection == m_coda_edge_selection && table_selections == m_coda_edge_table_selections)
+        {
+            return;
+        }
+        saveCodaSelection(selection, table_selections, edgeSelectionPath());
+    }
+
+    m_coda_edge_selection.swap(selection);
+    m_coda_edge_table_selections.swap(table_selections);
     emit edgeSelectionChanged();
+    propagateEdgeSelection();
 }
 
 
@@ -412,14 +848,248 @@ const std::vector<bool>& Coda::edgeSelection() const
 }
 
 
+/**
+ * Returns the edge selection in the index space of the spatialgraph 
+ * *graph*, see vertexSelection().
+ */
+std::vector<bool> Coda::edgeSelection(HxSpatialGraph* graph) const
+{
+    std::vector<bool> selection;
+    if(
+        graph->getNumEdges() != static_cast<std::int64_t>(m_coda_edge_selection.size())
+        && selectionFromChild(selection, graph, HxSpatialGraph::EDGE, m_coda_edge_selection)
+    ) {
+        return selection;
+    }
+    return m_coda_edge_selection;
+}
+
+
+/**
+ * Returns the selections Coda made on individual tables of a spreadsheet
+ * for the edges. The other tables use the common edge selection.
+ */
+const TableSelections& Coda::edgeTableSelections() const
+{
+    return m_coda_edge_table_selections;
+}
+
+
+/**
+ * Replaces the edge selection and writes it back to Coda, 
+ * using the same file Coda uses to share its selection.
+ */
+void Coda::writeEdgeSelection(const std::vector<bool>& selection)
+{
+    m_coda_edge_selection_seed = selection;
+    storeEdgeSelection(selection);
+}
+
+
+void Coda::storeEdgeSelection(const std::vector<bool>& selection)
+{
+    if(selection == m_coda_edge_selection)
+    {
+        return;
+    }
+
+    m_coda_edge_selection = selection;
+    if(!saveCodaSelection(m_coda_edge_selection, m_coda_edge_table_selections, edgeSelectionPath()))
+    {
+        qWarning() << "Could not write the edge selection.";
+    }
+    emit edgeSelectionChanged();
+}
+
+
+/**
+ * Derives the edge selection from the vertex selection, or vice versa, using
+ * the topology of *graph*. The derived selection is written back to Coda
+ * whenever the other selection changes.
+ */
+void Coda::setPropagation(HxSpatialGraph* graph, Propagation propagation)
+{
+    m_propagation_graph = graph;
+    m_propagation = graph ? propagation : PROPAGATE_NONE;
+
+    propagateVertexSelection();
+    propagateEdgeSelection();
+}
+
+
+Coda::Propagation Coda::propagation() const
+{
+    return m_propagation;
+}
+
+
+/**
+ * Grows the selections along the topology of *graph*: Either by *nhops*
+ * edges or to the whole connected components touching the selection.
+ * The expanded selections are written back to Coda.
+ */
+void Coda::setExpansion(HxSpatialGraph* graph, Expansion expansion, int nhops)
+{
+    m_expansion_graph = graph;
+    m_expansion = graph ? expansion : EXPAND_NONE;
+    m_expansion_hops = std::max(0, nhops);
+
+    // Expand the selections received from Coda again.
+    std::vector<bool> vertex_selection = m_coda_vertex_selection_seed;
+    expandVertexSelection(vertex_selection);
+    storeVertexSelection(vertex_selection);
+    propagateVertexSelection();
+
+    std::vector<bool> edge_selection = m_coda_edge_selection_seed;
+    expandEdgeSelection(edge_selection);
+    storeEdgeSelection(edge_selection);
+    propagateEdgeSelection();
+}
+
+
+Coda::Expansion Coda::expansion() const
+{
+    return m_expansion;
+}
+
+
+/**
+ * Expands the vertex *selection* in place. Returns false if no expansion
+ * is configured or the selection does not match the graph.
+ */
+bool Coda::expandVertexSelection(std::vector<bool>& selection)
+{
+    if(!m_expansion_graph || m_expansion == EXPAND_NONE)
+    {
+        return false;
+    }
+
+    const GraphAdjacency& graph_adjacency = adjacency(m_expansion_graph);
+    if(static_cast<std::int64_t>(selection.size()) != graph_adjacency.numVertices())
+    {
+        return false;
+    }
+
+    if(m_expansion == EXPAND_NEIGHBOURHOOD)
+    {
+        expandNeighbourhood(selection, graph_adjacency, m_expansion_hops);
+    }
+    else
+    {
+        expandComponents(selection, graph_adjacency);
+    }
+    return true;
+}
+
+
+/**
+ * Expands the edge *selection* in place. The edges within *n* hops are the 
+ * edges incident to the vertices within *n - 1* hops of the endpoints.
+ */
+bool Coda::expandEdgeSelection(std::vector<bool>& selection)
+{
+    if(!m_expansion_graph || m_expansion == EXPAND_NONE)
+    {
+        return false;
+    }
+
+    const GraphAdjacency& graph_adjacency = adjacency(m_expansion_graph);
+    if(static_cast<std::int64_t>(selection.size()) != graph_adjacency.numEdges())
+    {
+        return false;
+    }
+    if(m_expansion == EXPAND_NEIGHBOURHOOD && m_expansion_hops == 0)
+    {
+        return true;
+    }
+
+    std::vector<bool> vertices;
+    selectEndpoints(vertices, graph_adjacency, selection);
+    if(m_expansion == EXPAND_NEIGHBOURHOOD)
+    {
+        expandNeighbourhood(vertices, graph_adjacency, m_expansion_hops - 1);
+    }
+    else
+    {
+        expandComponents(vertices, graph_adjacency);
+    }
+    selectIncidentEdges(selection, graph_adjacency, vertices);
+    return true;
+}
+
+
+void Coda::propagateVertexSelection()
+{
+    if(
+        !m_propagation_graph 
+        || (m_propagation != PROPAGATE_INDUCED_EDGES && m_propagation != PROPAGATE_INCIDENT_EDGES)
+    ) {
+        return;
+    }
+
+    const GraphAdjacency& graph_adjacency = adjacency(m_propagation_graph);
+
+    // An empty vertex selection shows all vertices, so the derived 
+    // edge selection is empty as well.
+    std::vector<bool> selection;
+    if(static_cast<std::int64_t>(m_coda_vertex_selection.size()) == graph_adjacency.numVertices())
+    {
+        if(m_propagation == PROPAGATE_INDUCED_EDGES)
+        {
+            selectInducedEdges(selection, graph_adjacency, m_coda_vertex_selection);
+        }
+        else
+        {
+            selectIncidentEdges(selection, graph_adjacency, m_coda_vertex_selection);
+        }
+    }
+    writeEdgeSelection(selection);
+}
+
+
+void Coda::propagateEdgeSelection()
+{
+    if(!m_propagation_graph || m_propagation != PROPAGATE_ENDPOINTS)
+    {
+        return;
+    }
+
+    const GraphAdjacency& graph_adjacency = adjacency(m_propagation_graph);
+
+    std::vector<bool> selection;
+    if(static_cast<std::int64_t>(m_coda_edge_selection.size()) == graph_adjacency.numEdges())
+    {
+        selectEndpoints(selection, graph_adjacency, m_coda_edge_selection);
+    }
+    writeVertexSelection(selection);
+}
+
+
 QString Coda::vertexColormapPath()
 {
     return QDir(m_data_directory.path()).absoluteFilePath("coda_vertex_colormap.csv");
 }
 
 
+/**
+ * The binary per-item colors written by Coda, see readItemColors().
+ */
+QString Coda::vertexColorsPath()
+{
+    return QDir(m_data_directory.path()).absoluteFilePath("coda_vertex_colors.bin");
+}
+
+
 bool Coda::readVertexColormap()
 {
+    // Prefer the per-item colors if Coda wrote them last.
+    const QFileInfo colors_info(vertexColorsPath());
+    const QFileInfo colormap_info(vertexColormapPath());
+    if(colors_info.exists() && (!colormap_info.exists() || colormap_info.lastModified() <= colors_info.lastModified()))
+    {
+        return importItemColors(HxSpatialGraph::VERTEX);
+    }
+
     // Try to read the colormap.
     QString path = vertexColormapPath();
     McHandle<HxSpreadSheet> spreadsheet = HxSpreadSheet::createInstance();    
@@ -471,14 +1141,61 @@ bool Coda::writeVertexColormap(HxConnection& connection)
 }
 
 
+/**
+ * Pushes the colormap of the vertex data to Coda in the compact binary
+ * format, see colormapToBinary(). Nothing is written if the colormap 
+ * did not change since the last push.
+ */
+bool Coda::pushVertexColormap(HxConnection& connection)
+{
+    McHandle<HxColormap> colormap = colormapVertices(connection);
+    if(!colormap)
+    {
+        return false;
+    }
+
+    const QByteArray bytes = colormapToBinary(colormap);
+    const std::uint64_t hash = hashBytes(bytes);
+    if(hash == m_amira_vertex_colormap_hash)
+    {
+        return true;
+    }
+
+    QString path = QDir(m_data_directory.path()).absoluteFilePath("amira_vertex_colormap.bin");
+    if(!saveBytes(path, bytes))
+    {
+        return false;
+    }
+    m_amira_vertex_colormap_hash = hash;
+    return true;
+}
+
+
 QString Coda::edgeColormapPath()
 {
     return QDir(m_data_directory.path()).absoluteFilePath("coda_edge_colormap.csv");
 }
 
 
+/**
+ * The binary per-item colors written by Coda, see readItemColors().
+ */
+QString Coda::edgeColorsPath()
+{
+    return QDir(m_data_directory.path()).absoluteFilePath("coda_edge_colors.bin");
+}
+
+
 bool Coda::readEdgeColormap()
 {
+    // Prefer the per-item colors if Coda wrote them last.
+    const QFileInfo colors_info(edgeColorsPath());
+    const QFileInfo colormap_info(edgeColormapPath());
+    if(colors_info.exists() && (!colormap_info.exists() || colormap_info.lastModified() <= colors_info.lastModified()))
+    {
+        return importItemColors(HxSpatialGraph::EDGE);
+    }
+
     // Try to read the colormap.
     QString path = edgeColormapPath();
     McHandle<HxSpreadSheet> spreadsheet = HxSpreadSheet::createInstance();    
@@ -530,48 +1247,356 @@ bool Coda::writeEdgeColormap(HxConnection& connection)
 }
 
 
-CodaProcess* Coda::process()
+/**
+ * Pushes the colormap of the edge data to Coda in the compact binary
+ * format, see colormapToBinary(). Nothing is written if the colormap 
+ * did not change since the last push.
+ */
+bool Coda::pushEdgeColormap(HxConnection& connection)
+{
+    McHandle<HxColormap> colormap = colormapEdges(connection);
+    if(!colormap)
+    {
+        return false;
+    }
+
+    const QByteArray bytes = colormapToBinary(colormap);
+    const std::uint64_t hash = hashBytes(bytes);
+    if(hash == m_amira_edge_colormap_hash)
+    {
+        return true;
+    }
+
+    QString path = QDir(m_data_directory.path()).absoluteFilePath("amira_edge_colormap.bin");
+    if(!saveBytes(path, bytes))
+    {
+        return false;
+    }
+    m_amira_edge_colormap_hash = hash;
+    return true;
+}
+
+
+/**
+ * Imports the per-item colors written by Coda for the given item *type*. 
+ * The colors are written directly into the RGBA attribute of the 
+ * synchronized spatialgraphs, so no colormap with an entry per item is
+ * needed. Any other synchronized data uses the Coda colormap as lookup
+ * table.
+ */
+bool Coda::importItemColors(HxSpatialGraph::ItemType type)
+{
+    const bool is_vertex = type == HxSpatialGraph::VERTEX;
+
+    ItemColors colors;
+    if(!readItemColors(colors, is_vertex ? vertexColorsPath() : edgeColorsPath()))
+    {
+        return false;
+    }
+
+    bool is_lut_required = false;
+    const QMap<HxData*, QString>& data_to_path = is_vertex ? m_vertex_data_to_path : m_edge_data_to_path;
+    for(auto it = data_to_path.constBegin(); it != data_to_path.constEnd(); ++it)
+    {
+        HxSpatialGraph* graph = dynamic_cast<HxSpatialGraph*>(it.key());
+        if(graph && colorsToAttribute(graph, type, colors))
+        {
+            fireAttributeChange(graph);
+        }
+        else
+        {
+            is_lut_required = true;
+        }
+    }
+
+    if(!is_lut_required)
+    {
+        return true;
+    }
+
+    // Check if a colormap has already been created.
+    McHandle<HxColormap256>& colormap = is_vertex ? m_coda_vertex_colormap : m_coda_edge_colormap;
+    if(!colormap)
+    {
+        colormap = HxColormap256::createInstance();
+        colormap->setLabel(is_vertex ? "Coda_Vertex_Colormap" : "Coda_Edge_Colormap");
+        colormap->setLabelField(true);
+
+        const bool isHideNewModules = theObjectPool->isHideNewModules();
+        theObjectPool->setHideNewModules(true);
+        theObjectPool->addObject(colormap, true);
+        theObjectPool->setHideNewModules(isHideNewModules);
+    }
+
+    colorsToColormap(colormap, colors);
+    return true;
+}
+
+
+/**
+ * Touches and fires *graph* after hxcoda changed only the values of some
+ * of its attributes. The synchronized data modules and the filters can
+ * check isChangingAttributes() while the change is propagated, so that
+ * they neither rebuild the topology nor export the graph again.
+ */
+void Coda::fireAttributeChange(HxSpatialGraph* graph)
+{
+    // The cached results derived from the graph are outdated, 
+    // but not its topology.
+    auto it = m_graph_indices.find(graph);
+    if(it != m_graph_indices.end())
+    {
+        it->stamp = ++m_last_graph_stamp;
+    }
+
+    const bool was_changing = m_is_changing_attributes;
+    m_is_changing_attributes = true;
+    graph->touch();
+    graph->fire();
+    m_is_changing_attributes = was_changing;
+}
+
+
+bool Coda::isChangingAttributes() const
+{
+    return m_is_changing_attributes;
+}
+
+
+CodaProcess* Coda::process()
+{
+    return m_process;
+}
+
+
+QString Coda::dataDirectory()
+{
+    return m_data_directory.path();
+}
+
+
+/**
+ * Returns the cached adjacency index of the spatialgraph *graph*. The index
+ * is built on the first call and reused until invalidateAdjacency() is called,
+ * which the modules do when their input graph is touched. As a safeguard, the
+ * index is also rebuilt if the number of vertices or edges changed.
+ */
+const GraphAdjacency& Coda::adjacency(HxSpatialGraph* graph)
+{
+    graphStamp(graph);
+
+    QSharedPointer<GraphAdjacency>& adjacency = m_graph_indices[graph].adjacency;
+    if(!adjacency)
+    {
+        adjacency.reset(new GraphAdjacency());
+    }
+    if(!adjacency->matches(graph))
+    {
+        adjacency->build(graph);
+    }
+    return *adjacency;
+}
+
+
+/**
+ * Marks the topology of *graph* as modified: The adjacency index is dropped
+ * and the graph gets a new modification stamp.
+ */
+void Coda::invalidateAdjacency(HxSpatialGraph* graph)
+{
+    if(!graph)
+    {
+        return;
+    }
+
+    auto it = m_graph_indices.find(graph);
+    if(it != m_graph_indices.end())
+    {
+        it->stamp = ++m_last_graph_stamp;
+        it->adjacency.reset();
+    }
+    pruneGraphs();
+}
+
+
+/**
+ * Returns the modification stamp of *graph*. The stamp changes whenever
+ * invalidateAdjacency() or fireAttributeChange() is called for the graph. Stamps are never reused,
+ * not even for another graph at the same address, so a cache keyed by the
+ * graph and its stamp never returns the data of an outdated graph.
+ */
+std::uint64_t Coda::graphStamp(HxSpatialGraph* graph)
+{
+    auto it = m_graph_indices.find(graph);
+    if(it == m_graph_indices.end())
+    {
+        pruneGraphs();
+
+        GraphIndex index;
+        index.graph = graph;
+        index.stamp = ++m_last_graph_stamp;
+        it = m_graph_indices.insert(graph, index);
+    }
+    return it->stamp;
+}
+
+
+/**
+ * Returns true if *graph* is only referenced by the graph indices and the
+ * parent map, i.e. it has been deleted everywhere else.
+ */
+bool Coda::isOrphaned(HxSpatialGraph* graph) const
+{
+    int nrefs = m_graph_indices.contains(graph) ? 1 : 0;
+    for(auto it = m_graph_parents.constBegin(); it != m_graph_parents.constEnd(); ++it)
+    {
+        nrefs += it->child == graph ? 1 : 0;
+        nrefs += it->parent == graph ? 1 : 0;
+    }
+    return graph->refcount() <= nrefs;
+}
+
+
+/**
+ * Removes the graph indices and parents of the graphs which have been
+ * deleted everywhere else. Removing a child may orphan its parent, so
+ * this is repeated until nothing changes.
+ */
+void Coda::pruneGraphs()
+{
+    bool is_pruned = true;
+    while(is_pruned)
+    {
+        is_pruned = false;
+        for(auto it = m_graph_parents.begin(); it != m_graph_parents.end();)
+        {
+            if(isOrphaned(it->child))
+            {
+                it = m_graph_parents.erase(it);
+                is_pruned = true;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        for(auto it = m_graph_indices.begin(); it != m_graph_indices.end();)
+        {
+            if(isOrphaned(it->graph))
+            {
+                it = m_graph_indices.erase(it);
+                is_pruned = true;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+}
+
+
+/**
+ * Remembers that *child* has been filtered from *parent*. Selections made
+ * in Coda on the exported child are then mapped back to the parent by
+ * vertexSelection() and edgeSelection().
+ *
+ * The owner of the child should call removeParentGraph() when the child
+ * is replaced or released. Children deleted without it are ignored and
+ * eventually pruned.
+ */
+void Coda::setParentGraph(HxSpatialGraph* child, HxSpatialGraph* parent)
 {
-    return m_process;
+    pruneGraphs();
+
+    GraphParent entry;
+    entry.child = child;
+    entry.parent = parent;
+    m_graph_parents.insert(child, entry);
 }
 
 
-QString Coda::dataDirectory()
+void Coda::removeParentGraph(HxSpatialGraph* child)
 {
-    return m_data_directory.path();
+    m_graph_parents.remove(child);
 }
 
 
 void Coda::loadCodaSelection(
     std::vector<bool>& selection, 
-    McHandle<HxSpreadSheet>& spreadsheet,
+    TableSelections& table_selections,
     const QString path
 ) {
-    // Read the csv spreadsheet.
-    if(!spreadsheet)
+    table_selections.clear();
+    selection.clear();
+
+    // The selection file is read directly instead of into a spreadsheet, 
+    // whose row indices are limited to 32 bit.
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
     {
-        spreadsheet = HxSpreadSheet::createInstance();
+        return;
     }
-    readCSVDataToSpreadSheet(path.toLocal8Bit(), spreadsheet);
 
-    // Find the column containing the selection mask.  
-    const int icol = spreadsheet->findColumn("selected", HxSpreadSheet::Column::INT);
-    const HxSpreadSheet::Column* column = icol >= 0 ? spreadsheet->column(icol) : nullptr;
+    std::vector<SelectionColumn> columns;
+    readSelectionCsv(columns, [&file](char* data, std::int64_t size) {
+        return static_cast<std::int64_t>(file.read(data, size));
+    });
 
-    // Convert the selection to a vector.
-    if(column != nullptr)
+    // The column "selected" contains the common selection mask and the 
+    // columns "selected_<k>" the masks of individual tables.
+    for(SelectionColumn& column : columns)
     {
-        const int nrows = spreadsheet->nRows();
-        selection.resize(nrows);
-        for(int irow = 0; irow < nrows; ++irow)
+        const QString name = QString::fromStdString(column.name);
+        if(name == "selected")
+        {
+            selection.swap(column.mask);
+        }
+        else
         {
-            selection[irow] = column->intValue(irow);
+            bool ok = false;
+            const int itable = name.mid(9).toInt(&ok);
+            if(!ok || itable < 0)
+            {
+                continue;
+            }
+            table_selections[itable].swap(column.mask);
         }
     }
-    else
+}
+
+
+bool Coda::saveCodaSelection(
+    const std::vector<bool>& selection,
+    const TableSelections& table_selections,
+    const QString path
+) {
+    // Use the format written by Coda, see loadCodaSelection().
+    std::vector<std::string> names = {"selected"};
+    std::vector<const std::vector<bool>*> masks = {&selection};
+    for(auto it = table_selections.constBegin(); it != table_selections.constEnd(); ++it)
+    {
+        names.push_back(QString("selected_%1").arg(it.key()).toStdString());
+        masks.push_back(&it.value());
+    }
+
+    // Coda only sees the complete file.
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
     {
-        selection.clear();
+        return false;
+    }
+
+    const bool ok = writeSelectionCsv([&file](const char* data, std::int64_t size) {
+        return file.write(data, size) == size;
+    }, names, masks);
+
+    if(!ok)
+    {
+        file.cancelWriting();
+        return false;
     }
+    return file.commit();
 }
 
 
@@ -585,11 +1610,11 @@ void Coda::on_watcher_fileChanged(const QString& path)
     {
         rescheduleReadEdgeSelection();
     }
-    if(path == vertexColormapPath())
+    if(path == vertexColormapPath() || path == vertexColorsPath())
     {
         rescheduleReadVertexColormap();
     }
-    if(path == edgeColormapPath())
+    if(path == edgeColormapPath() || path == edgeColorsPath())
     {
         rescheduleReadEdgeColormap();
     }
@@ -598,6 +1623,9 @@ void Coda::on_watcher_fileChanged(const QString& path)
 
 void Coda::on_watcher_directoryChanged(const QString& path)
 {
+    // Coda requested data objects.
+    readExportRequests();
+
     // vertexSelectionPath()
     {
         const QString path = vertexSelectionPath();
@@ -618,9 +1646,9 @@ void Coda::on_watcher_directoryChanged(const QString& path)
         }
     }
 
-    // vertexColormapPath()
+    // vertexColormapPath() and vertexColorsPath()
+    for(const QString& path: {vertexColormapPath(), vertexColorsPath()})
     {
-        const QString path = vertexColormapPath();
         if(QFileInfo(path).exists() && !m_watcher->files().contains(path))
         {
             rescheduleReadVertexColormap();
@@ -628,9 +1656,9 @@ void Coda::on_watcher_directoryChanged(const QString& path)
         }
     }
 
-    // edgeColormapPath()
+    // edgeColormapPath() and edgeColorsPath()
+    for(const QString& path: {edgeColormapPath(), edgeColorsPath()})
     {
-        const QString path = edgeColormapPath();
         if(QFileInfo(path).exists() && !m_watcher->files().contains(path))
         {
             rescheduleReadEdgeColormap();
@@ -685,28 +1713,27 @@ std::shared_ptr<Coda> theCoda()
 
 void select(
     HxSpreadSheet* input, 
-    const std::vector<bool>& selection
+    const std::vector<bool>& selection,
+    const TableSelections& table_selections
 )
 {
     const int ntables = input->nTables();
-    const int nselection = static_cast<int>(selection.size());
 
-    // Apply the selection to all tables in the spreadsheet.
+    // Convert each distinct selection to an index set only once.
     // Rows with indices exceeding the *selection* size cannot be selected
     // and are ignored.
+    RowIndices rows;
+    selectedRows(rows, input, selection, table_selections);
+
     for(int itable = 0; itable < ntables; ++itable)
     {
-        const int nrows = input->nRows();
+        // Skip the rows beyond the end of the current table, which 
+        // shares the index set with a longer one.
+        const std::vector<int>& table_rows = rows.table(itable);
+        const auto end = std::lower_bound(table_rows.begin(), table_rows.end(), input->nRows(itable));
 
-        // Convert the selection to an index set.
-        auto indices = McDArray<int>();
-        for(int irow = 0; irow < nrows; ++irow)
-        {
-            if(irow < nselection && selection[irow])
-            {
-                indices.push_back(irow);
-            }
-        }
+        auto indices = McDArray<int>(static_cast<int>(end - table_rows.begin()));
+        std::copy(table_rows.begin(), end, indices.dataPtr());
 
         // Select the rows in the current table.
         input->setRowSelection(indices, itable);
@@ -719,57 +1746,25 @@ void filterVertices(
     HxSpatialGraph* input, 
     const std::vector<bool>& selection
 ) {
-    const int nvertices = input->getNumVertices();
-    const int nedges = input->getNumEdges();
+    // Selections on the result can be mapped back to the input.
+    theCoda()->setParentGraph(result, input);
 
-    SpatialGraphSelection graph_selection(nvertices, nedges);
+    const GraphAdjacency& adjacency = theCoda()->adjacency(input);
+    const std::int64_t nvertices = adjacency.numVertices();
+    const std::int64_t nedges = adjacency.numEdges();
 
     // Show all vertices by default if no selection mask is given
     // or the size does not match the graph.
-    if(nvertices != static_cast<int>(selection.size()))
-    {
-        graph_selection.selectAllVertices();
-        graph_selection.selectAllEdges();
-        graph_selection.selectAllPoints();
-    }
-    // Apply the selection.
-    else
+    if(nvertices != static_cast<std::int64_t>(selection.size()))
     {
-        graph_selection.deselectAllVertices();
-        graph_selection.deselectAllEdges();
-        graph_selection.deselectAllPoints();
-        
-        // Select all vertices.
-        for(int ivertex = 0; ivertex < nvertices; ++ivertex)
-        {
-            if(selection[ivertex])
-            {
-                graph_selection.selectVertex(ivertex);
-            }
-        }
-
-        // Select all edges connected to vertices in the selection.
-        for(int iedge = 0; iedge < nedges; ++iedge)
-        {
-            const int ivertex_source = input->getEdgeSource(iedge);
-            if(ivertex_source >= nvertices || !selection[ivertex_source])
-            {
-                continue;
-            }
-
-            const int ivertex_target = input->getEdgeTarget(iedge);
-            if(ivertex_target >= nvertices || !selection[ivertex_target])
-            {
-                continue;
-            }
-
-            graph_selection.selectEdge(iedge);
-        }
+        copySubgraph(result, input, adjacency, std::vector<bool>(nvertices, true), std::vector<bool>(nedges, true));
+        return;
     }
 
-    // Filter the graph.
-    McHandle<HxSpatialGraph> temporaryGraph = input->getSubgraph(graph_selection);
-    result->copyFrom(temporaryGraph);
+    // Select all edges connected to vertices in the selection.
+    std::vector<bool> edges;
+    selectInducedEdges(edges, adjacency, selection);
+    copySubgraph(result, input, adjacency, selection, edges);
 }
 
 
@@ -778,52 +1773,166 @@ void filterEdges(
     HxSpatialGraph* input, 
     const std::vector<bool>& selection
 ) {
-    const int nvertices = input->getNumVertices();
-    const int nedges = input->getNumEdges();
+    // Selections on the result can be mapped back to the input.
+    theCoda()->setParentGraph(result, input);
 
-    SpatialGraphSelection graph_selection(nvertices, nedges);
+    const GraphAdjacency& adjacency = theCoda()->adjacency(input);
+    const std::int64_t nvertices = adjacency.numVertices();
+    const std::int64_t nedges = adjacency.numEdges();
 
     // Select all edges if the selection mask is empty. This is a convention also
     // used in Coda. *No selection* means all items are visibile/unmuted.
-    if(nedges != static_cast<int>(selection.size()))
+    if(nedges != static_cast<std::int64_t>(selection.size()))
     {
-        graph_selection.selectAllVertices();
-        graph_selection.selectAllEdges();
-        graph_selection.selectAllPoints();
+        copySubgraph(result, input, adjacency, std::vector<bool>(nvertices, true), std::vector<bool>(nedges, true));
+        return;
     }
-    // Apply the selection.
-    else
+
+    // Select the endpoints of the selected edges.
+    std::vector<bool> vertices;
+    selectEndpoints(vertices, adjacency, selection);
+    copySubgraph(result, input, adjacency, vertices, selection);
+}
+
+
+void filterGraph(
+    HxSpatialGraph* result,
+    HxSpatialGraph* input,
+    const std::vector<bool>& vertex_selection,
+    const std::vector<bool>& edge_selection,
+    bool is_union
+) {
+    // Selections on the result can be mapped back to the input.
+    theCoda()->setParentGraph(result, input);
+
+    const GraphAdjacency& adjacency = theCoda()->adjacency(input);
+    const std::int64_t nvertices = adjacency.numVertices();
+    const std::int64_t nedges = adjacency.numEdges();
+
+    // The subgraph of filterVertices(). It is the whole graph 
+    // if the selection does not match.
+    std::vector<bool> vertices(nvertices, true);
+    std::vector<bool> edges(nedges, true);
+    if(nvertices == static_cast<std::int64_t>(vertex_selection.size()))
+    {
+        vertices = vertex_selection;
+        selectInducedEdges(edges, adjacency, vertex_selection);
+    }
+
+    // The subgraph of filterEdges().
+    if(nedges == static_cast<std::int64_t>(edge_selection.size()))
     {
-        graph_selection.deselectAllVertices();
-        graph_selection.deselectAllEdges();
-        graph_selection.deselectAllPoints();
+        std::vector<bool> endpoints;
+        selectEndpoints(endpoints, adjacency, edge_selection);
 
-        for(int iedge = 0; iedge < nedges; ++iedge)
+        // Combine both subgraphs. Each edge is kept with both endpoints in
+        // either case, so the result is a valid subgraph.
+        for(std::int64_t ivertex = 0; ivertex < nvertices; ++ivertex)
         {
-            if(!selection[iedge])
-            {
-                continue;
-            }
+            vertices[ivertex] = is_union 
+                ? (vertices[ivertex] || endpoints[ivertex])
+                : (vertices[ivertex] && endpoints[ivertex]);
+        }
+        for(std::int64_t iedge = 0; iedge < nedges; ++iedge)
+        {
+            edges[iedge] = is_union
+                ? (edges[iedge] || edge_selection[iedge])
+                : (edges[iedge] && edge_selection[iedge]);
+        }
+    }
 
-            graph_selection.selectEdge(iedge);
-            
-            const int ivertex_source = input->getEdgeSource(iedge);
-            if(ivertex_source < nvertices)
-            {
-                graph_selection.selectVertex(ivertex_source);
-            }
+    copySubgraph(result, input, adjacency, vertices, edges);
+}
 
-            const int ivertex_target = input->getEdgeTarget(iedge);
-            if(ivertex_target < nvertices)
-            {
-                graph_selection.selectVertex(ivertex_target);
-            }
-        }
+
+const char* const SELECTION_ATTRIBUTE = "coda_selected";
+
+
+/**
+ * Returns the integer attribute SELECTION_ATTRIBUTE of the given *type*,
+ * creating it if it does not exist yet.
+ */
+static EdgeVertexAttribute* selectionAttribute(
+    HxSpatialGraph* graph,
+    HxSpatialGraph::ItemType type
+) {
+    auto attribute = dynamic_cast<EdgeVertexAttribute*>(graph->findAttribute(type, SELECTION_ATTRIBUTE));
+    if(attribute && (attribute->primType() != McPrimType::MC_INT32 || attribute->nDataVar() != 1))
+    {
+        graph->deleteAttribute(attribute);
+        attribute = nullptr;
     }
-    
-    // Filter the graph.
-    McHandle<HxSpatialGraph> temporaryGraph = input->getSubgraph(graph_selection);
-    result->copyFrom(temporaryGraph);
+    if(!attribute)
+    {
+        attribute = dynamic_cast<EdgeVertexAttribute*>(
+            graph->addAttribute(SELECTION_ATTRIBUTE, type, McPrimType::MC_INT32, 1)
+        );
+    }
+    return attribute;
+}
+
+
+/**
+ * Writes the selection mask *selection* into the selection attribute
+ * of the given item *type*.
+ */
+static void writeSelectionAttribute(
+    HxSpatialGraph* graph,
+    HxSpatialGraph::ItemType type,
+    const std::vector<bool>& selection
+) {
+    EdgeVertexAttribute* attribute = selectionAttribute(graph, type);
+    const std::int64_t nitems = static_cast<std::int64_t>(selection.size());
+    for(std::int64_t iitem = 0; iitem < nitems; ++iitem)
+    {
+        attribute->setIntDataAtIdx(static_cast<int>(iitem), selection[iitem]);
+    }
+}
+
+
+void markVertices(
+    HxSpatialGraph* graph,
+    const std::vector<bool>& selection
+) {
+    const GraphAdjacency& adjacency = theCoda()->adjacency(graph);
+    const std::int64_t nvertices = adjacency.numVertices();
+    const std::int64_t nedges = adjacency.numEdges();
+
+    // Mark all items if the selection mask does not match the graph,
+    // see filterVertices().
+    std::vector<bool> vertices(nvertices, true);
+    std::vector<bool> edges(nedges, true);
+    if(nvertices == static_cast<std::int64_t>(selection.size()))
+    {
+        vertices = selection;
+        selectInducedEdges(edges, adjacency, selection);
+    }
+
+    writeSelectionAttribute(graph, HxSpatialGraph::VERTEX, vertices);
+    writeSelectionAttribute(graph, HxSpatialGraph::EDGE, edges);
+}
+
+
+void markEdges(
+    HxSpatialGraph* graph,
+    const std::vector<bool>& selection
+) {
+    const GraphAdjacency& adjacency = theCoda()->adjacency(graph);
+    const std::int64_t nvertices = adjacency.numVertices();
+    const std::int64_t nedges = adjacency.numEdges();
+
+    // Mark all items if the selection mask does not match the graph,
+    // see filterEdges().
+    std::vector<bool> vertices(nvertices, true);
+    std::vector<bool> edges(nedges, true);
+    if(nedges == static_cast<std::int64_t>(selection.size()))
+    {
+        edges = selection;
+        selectEndpoints(vertices, adjacency, selection);
+    }
+
+    writeSelectionAttribute(graph, HxSpatialGraph::VERTEX, vertices);
+    writeSelectionAttribute(graph, HxSpatialGraph::EDGE, edges);
 }
 
 
@@ -844,10 +1953,22 @@ void filter(
     {
         result->copyData(*input);
     }
+    // Filter the raw voxel data with the typed kernels if possible.
+    else if(isLabelKernelType(input->primType()))
+    {
+        filterLabelKernel(
+            result->lattice().dataPtr(),
+            input->lattice().dataPtr(),
+            input->primType(),
+            static_cast<std::int64_t>(dims.nx)*static_cast<std::int64_t>(dims.ny),
+            static_cast<std::int64_t>(dims.nz),
+            selection
+        );
+    }
     // Filter based on the input field.
     else
     {
-        const int nrows = static_cast<int>(selection.size());
+        const std::int64_t nrows = static_cast<std::int64_t>(selection.size());
         const float bg_value = 0.0f;
         
         for(int iz = 0; iz < dims.nz; ++iz)
@@ -858,7 +1979,7 @@ void filter(
                 {
                     const float value = input->evalReg(ix, iy, iz);
                     float result_value = bg_value;
-                    const int label = static_cast<int>(value);
+                    const std::int64_t label = static_cast<std::int64_t>(value);
 
                     // Note the offset: The first foreground label has the value 1
                     // while the first row has index 0.
@@ -877,6 +1998,178 @@ void filter(
 }
 
 
+bool filterCompact(
+    HxUniformLabelField3* result, 
+    HxUniformLabelField3* input, 
+    const std::vector<bool>& selection,
+    HxSpreadSheet* mapping
+)
+{
+    const McPrimType input_type = input->primType();
+    if(!isLabelKernelType(input_type))
+    {
+        return false;
+    }
+
+    // The lookup table covers all labels which can be selected. An empty 
+    // selection keeps all labels.
+    float min_label = 0.0f;
+    float max_label = 0.0f;
+    input->getRange(min_label, max_label);
+
+    const std::int64_t nrows = selection.empty()
+        ? std::max<std::int64_t>(0, static_cast<std::int64_t>(max_label))
+        : static_cast<std::int64_t>(selection.size());
+
+    // Number the surviving labels consecutively.
+    // Note the offset: The first foreground label has the value 1
+    // while the first row has index 0.
+    std::vector<std::int32_t> lut(nrows + 1, 0);
+    std::vector<std::int32_t> original_labels;
+    for(std::int64_t label = 1; label <= nrows; ++label)
+    {
+        if(selection.empty() || selection[label - 1])
+        {
+            original_labels.push_back(static_cast<std::int32_t>(label));
+            lut[label] = static_cast<std::int32_t>(original_labels.size());
+        }
+    }
+
+    // Configure the result field to match the input field, but 
+    // use the smallest possible label type.
+    const auto dims = input->lattice().getDims();
+    const McPrimType result_type = compactLabelType(static_cast<std::int64_t>(original_labels.size()));
+    result->lattice().setPrimType(result_type);
+    result->lattice().resize(dims);
+    result->lattice().setBoundingBox(input->getBoundingBox());
+
+    relabelKernel(
+        result->lattice().dataPtr(),
+        result_type,
+        input->lattice().dataPtr(),
+        input_type,
+        static_cast<std::int64_t>(dims.nx)*static_cast<std::int64_t>(dims.ny),
+        static_cast<std::int64_t>(dims.nz),
+        lut
+    );
+    result->touchMinMax();
+
+    // Store the mapping from the new to the original labels.
+    const int nlabels = static_cast<int>(original_labels.size());
+
+    mapping->clear();
+    mapping->setNumRows(nlabels);
+    mapping->addColumn("label", HxSpreadSheet::Column::INT);
+    mapping->addColumn("original_label", HxSpreadSheet::Column::INT);
+
+    HxSpreadSheet::Column* col_label = mapping->column(mapping->findColumn("label", HxSpreadSheet::Column::INT));
+    HxSpreadSheet::Column* col_original = mapping->column(mapping->findColumn("original_label", HxSpreadSheet::Column::INT));
+    // The labels are written as integers. A float only represents the
+    // integers up to 2^24 exactly.
+    for(int irow = 0; irow < nlabels; ++irow)
+    {
+        col_label->setValue(irow, static_cast<int>(irow + 1));
+        col_original->setValue(irow, static_cast<int>(original_labels[irow]));
+    }
+    return true;
+}
+
+
+void LabelFilterCache::invalidate()
+{
+    index.clear();
+    applied_selection.clear();
+    valid = false;
+}
+
+
+void filter(
+    HxUniformLabelField3* result, 
+    HxUniformLabelField3* input, 
+    const std::vector<bool>& selection,
+    LabelFilterCache& cache
+)
+{
+    const auto dims = input->lattice().getDims();
+    const auto result_dims = result->lattice().getDims();
+    const std::int64_t nx = dims.nx;
+    const std::int64_t ny = dims.ny;
+    const std::int64_t nz = dims.nz;
+
+    // The result can only be updated incrementally if it still contains
+    // the input filtered with the last selection. An empty selection 
+    // shows all labels and is therefore always applied fully.
+    const bool incremental = cache.valid
+        && !selection.empty()
+        && !cache.applied_selection.empty()
+        && isLabelKernelType(input->primType())
+        && result->primType() == input->primType()
+        && result_dims.nx == dims.nx
+        && result_dims.ny == dims.ny
+        && result_dims.nz == dims.nz;
+
+    if(incremental)
+    {
+        // Build the index lazily, i.e. only when the selection changes 
+        // for the first time.
+        if(!cache.index.matches(input->primType(), nx, ny, nz))
+        {
+            cache.index.build(input->lattice().dataPtr(), input->primType(), nx, ny, nz);
+        }
+        cache.index.apply(result->lattice().dataPtr(), selection, cache.applied_selection);
+        result->touchMinMax();
+    }
+    else
+    {
+        filter(result, input, selection);
+    }
+
+    cache.applied_selection = selection;
+    cache.valid = true;
+}
+
+
+void colormapMask(
+    HxColormap256* result,
+    HxColormap* base,
+    const std::vector<bool>& selection,
+    int nlabels
+) {
+    // The colormap covers at most the 32 bit label range.
+    const std::int64_t nrows = static_cast<std::int64_t>(selection.size());
+    const int ncolors = static_cast<int>(std::min<std::int64_t>(
+        std::max<std::int64_t>(nlabels, nrows + 1), std::numeric_limits<int>::max()
+    ));
+
+    result->resize(ncolors);
+    result->setInterpolate(false);
+    result->setLabelField(true);
+    result->setOutOfBoundsBehavior(HxColormap256::DEFAULT_CLAMP);
+
+    for(int label = 0; label < ncolors; ++label)
+    {
+        float rgba[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        if(base)
+        {
+            base->getRGBA(static_cast<float>(label), rgba);
+        }
+
+        // Note the offset: The first foreground label has the value 1
+        // while the first row has index 0.
+        const bool visible = 0 < label && (
+            selection.empty() || (label <= nrows && selection[label - 1])
+        );
+        if(!visible)
+        {
+            rgba[3] = 0.0f;
+        }
+        result->setRGBA(label, rgba);
+    }
+
+    result->setMinMax(0.0f, static_cast<float>(ncolors) - 1.0f);
+}
+
+
 /**
  * Internal method used to obtain a colormap from an HxColormapPort.
  */
@@ -939,89 +2232,6 @@ McHandle<HxColormap> colormapEdges(HxConnection& connection)
 }
 
 
-/**
- * Helper function to convert a float RGBA color into a hex-coded
- * string representation.
- */
-static std::string rgbaToHex(const float rgba[4])
-{
-    std::ostringstream ss;
-    ss 
-        << "#"
-        << std::hex << std::max(0, std::min(255, static_cast<int>(255.0f*rgba[0])))
-        << std::hex << std::max(0, std::min(255, static_cast<int>(255.0f*rgba[1])))
-        << std::hex << std::max(0, std::min(255, static_cast<int>(255.0f*rgba[2])))
-        << std::hex << std::max(0, std::min(255, static_cast<int>(255.0f*rgba[3])));
-    return ss.str();
-}
-
-
-/**
- * Extract a color from a hex coded RGBA value.
- */
-static bool rgbaFromHex(float rgba[4], std::string hex)
-{
-    rgba[0] = 1.0f;
-    rgba[1] = 1.0f;
-    rgba[2] = 1.0f;
-    rgba[3] = 1.0f;
-
-    if(hex.size() < 1 || hex[0] != '#')
-    {
-        return false;
-    }
-
-    // red
-    if(hex.size() >= 3)
-    {
-        std::string svalue = hex.substr(1, 2);
-        std::stringstream ss(svalue);
-
-        int ivalue = 0;
-        ss >> std::hex >> ivalue;
-
-        rgba[0] = static_cast<float>(ivalue)/255.0f;
-    }
-
-    // green
-    if(hex.size() >= 5)
-    {
-        std::string svalue = hex.substr(3, 2);
-        std::stringstream ss(svalue);
-
-        int ivalue = 0;
-        ss >> std::hex >> ivalue;
-
-        rgba[1] = static_cast<float>(ivalue)/255.0f;
-    }
-
-    // blue 
-    if(hex.size() >= 7)
-    {
-        std::string svalue = hex.substr(5, 2);
-        std::stringstream ss(svalue);
-
-        int ivalue = 0;
-        ss >> std::hex >> ivalue;
-
-        rgba[2] = static_cast<float>(ivalue)/255.0f;
-    }
-
-    // alpha
-    if(hex.size() >= 9)
-    {
-        std::string svalue = hex.substr(7, 2);
-        std::stringstream ss(svalue);
-
-        int ivalue = 0;
-        ss >> std::hex >> ivalue;
-
-        rgba[3] = static_cast<float>(ivalue)/255.0f;
-    }
-    return true;
-}
-
-
 void colormapToSpreadSheet(
     HxSpreadSheet* spreadsheet, 
     HxColormap* colormap
@@ -1054,10 +2264,11 @@ void colormapToSpreadSheet(
             float rgba[4] = {0.0f, 0.0f, 0.0f, 0.0f};
             colormap256->getRGBA(icolor, rgba);
 
-            std::string hex_rgba = rgbaToHex(rgba);
+            char hex_rgba[10];
+            rgbaToHex(hex_rgba, rgba);
 
             col_value->setValue(icolor, static_cast<float>(icolor));
-            col_rgba->setValue(icolor, hex_rgba.c_str());
+            col_rgba->setValue(icolor, hex_rgba);
         }
     }
     // In this case, we can only assume at continuous colormap
@@ -1081,12 +2292,70 @@ void colormapToSpreadSheet(
             float rgba[4] = {0.0f, 0.0f, 0.0f, 0.0f};
             colormap->getRGBA(x, rgba);
 
-            std::string hex_rgba = rgbaToHex(rgba);
+            char hex_rgba[10];
+            rgbaToHex(hex_rgba, rgba);
 
             col_value->setValue(isample, x);
-            col_rgba->setValue(isample, hex_rgba.c_str());
+            col_rgba->setValue(isample, hex_rgba);
+        }
+    }
+}
+
+
+/**
+ * Appends the little endian unsigned integer *value* with *nbytes*
+ * bytes to *bytes*.
+ */
+static void appendLittleEndian(QByteArray& bytes, std::uint32_t value, int nbytes)
+{
+    for(int ibyte = 0; ibyte < nbytes; ++ibyte)
+    {
+        bytes.append(static_cast<char>((value >> (8*ibyte)) & 0xFF));
+    }
+}
+
+
+QByteArray colormapToBinary(HxColormap* colormap)
+{
+    // Sample the colormap like colormapToSpreadSheet().
+    HxColormap256* colormap256 = dynamic_cast<HxColormap256*>(colormap);
+    const int ncolors = colormap256 ? colormap256->getSize() : 256;
+    const float xmin = colormap256 ? 0.0f : colormap->minCoord();
+    const float xmax = colormap256 ? static_cast<float>(ncolors - 1) : colormap->maxCoord();
+    const float xstep = ncolors > 1 ? (xmax - xmin)/static_cast<float>(ncolors - 1) : 0.0f;
+
+    QByteArray bytes;
+    bytes.reserve(20 + 4*ncolors);
+    bytes.append("AMIRACMP", 8);
+    appendLittleEndian(bytes, static_cast<std::uint32_t>(ncolors), 4);
+
+    std::uint32_t xbits = 0;
+    std::memcpy(&xbits, &xmin, 4);
+    appendLittleEndian(bytes, xbits, 4);
+    std::memcpy(&xbits, &xmax, 4);
+    appendLittleEndian(bytes, xbits, 4);
+
+    for(int icolor = 0; icolor < ncolors; ++icolor)
+    {
+        float rgba[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        if(colormap256)
+        {
+            colormap256->getRGBA(icolor, rgba);
+        }
+        else
+        {
+            colormap->getRGBA(xmin + xstep*static_cast<float>(icolor), rgba);
+        }
+
+        std::uint32_t packed = 0;
+        for(int ichannel = 0; ichannel < 4; ++ichannel)
+        {
+            const int value = std::max(0, std::min(255, static_cast<int>(255.0f*rgba[ichannel] + 0.5f)));
+            packed |= static_cast<std::uint32_t>(value) << (8*ichannel);
         }
+        appendLittleEndian(bytes, packed, 4);
     }
+    return bytes;
 }
 
 
@@ -1115,12 +2384,22 @@ bool colormapFromSpreadSheet(
     colormap->setInterpolate(false);
     colormap->setOutOfBoundsBehavior(HxColormap256::DEFAULT_CLAMP);
 
+    // The spreadsheet is not documented as thread-safe, so the strings are
+    // read on this thread into a buffer, which is then decoded in parallel.
+    // A color has at most HEX_RGBA_SIZE - 1 characters.
+    std::vector<char> hex(HEX_RGBA_SIZE*static_cast<std::size_t>(ncolors), '\0');
     for(int icolor = 0; icolor < ncolors; ++icolor)
-    {            
-        std::string hex_color = col_rgba->stringValue(icolor).dataPtr();
-        float rgba[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-        rgbaFromHex(rgba, hex_color);
-        colormap->setRGBA(icolor, rgba);
+    {
+        const McString value = col_rgba->stringValue(icolor);
+        std::strncpy(&hex[HEX_RGBA_SIZE*static_cast<std::size_t>(icolor)], value.dataPtr(), HEX_RGBA_SIZE - 1);
+    }
+
+    std::vector<float> rgba(4*static_cast<std::size_t>(ncolors));
+    rgbaFromHexColumn(rgba.data(), hex.data(), ncolors);
+
+    for(int icolor = 0; icolor < ncolors; ++icolor)
+    {
+        colormap->setRGBA(icolor, &rgba[4*static_cast<std::size_t>(icolor)]);
     }
 
     colormap->setMinMax(0.0f, static_cast<float>(ncolors) - 1.0f);
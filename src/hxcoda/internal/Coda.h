@@ -1,14 +1,17 @@
 #pragma once
 
 // STL
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 // Qt
+#include <QByteArray>
 #include <QDir>
 #include <QObject>
 #include <QString>
 #include <QMap>
+#include <QSet>
 #include <QSharedPointer>
 #include <QFileSystemWatcher>
 #include <QTemporaryDir>
@@ -23,6 +26,10 @@
 
 // Local
 #include <hxcoda/internal/CodaProcess.h>
+#include <hxcoda/internal/ExportThrottle.h>
+#include <hxcoda/internal/GraphAdjacency.h>
+#include <hxcoda/internal/LabelIndex.h>
+#include <hxcoda/internal/SpreadSheetFilter.h>
 
 
 namespace coda
@@ -39,16 +46,58 @@ namespace coda
  * When Coda detects a new spreadsheet in this directory, it is automatically 
  * made available in Coda.
  * 
+ * The data objects are exported lazily. When they are attached, they are only
+ * described in the manifest ``amira_manifest.json`` (file name, row count and
+ * columns). Coda requests a data object by creating the file 
+ * ``<file name>.request``. The data object is written on the first request
+ * and kept up to date afterwards.
+ * 
  * Similarly, if Coda updates the current edge or vertex selection spreadsheet,
  * this class will detect the file change and reload it and making the selection
  * available in Amira.
  * 
+ * Besides the common selection in the column ``selected``, the selection
+ * file may contain a column ``selected_<k>`` for each table *k* of a
+ * spreadsheet which Coda selected individually.
+ * 
+ * Instead of a colormap, Coda may also export the color of each item in a
+ * compact binary file, which is written directly into the synchronized
+ * spatialgraphs, see readItemColors().
+ * 
  * If possible, the files are stored in-memory, e.g. in ``/dev/shm/``.
  */
 class Coda : public QObject
 {
     Q_OBJECT
 
+public:
+
+    /// The modes of the selection propagation between the vertices
+    /// and edges of a spatialgraph.
+    enum Propagation
+    {
+        /// The vertex and edge selections are independent.
+        PROPAGATE_NONE = 0,
+        /// Select the edges with both endpoints selected.
+        PROPAGATE_INDUCED_EDGES = 1,
+        /// Select the edges with at least one endpoint selected.
+        PROPAGATE_INCIDENT_EDGES = 2,
+        /// Select the endpoints of the selected edges.
+        PROPAGATE_ENDPOINTS = 3
+    };
+
+    /// The modes of the selection expansion along a spatialgraph.
+    enum Expansion
+    {
+        /// The selections are used as they are.
+        EXPAND_NONE = 0,
+        /// Add all items within a number of hops.
+        EXPAND_NEIGHBOURHOOD = 1,
+        /// Add all items in the connected components touching
+        /// the selection.
+        EXPAND_COMPONENTS = 2
+    };
+
 public:
 
     explicit Coda(QObject* parent = nullptr);
@@ -57,40 +106,92 @@ public:
     bool addVertexData(HxData* data);
     void removeVertexData(HxData* data);
     void writeVertexData(HxData* data);
+    void scheduleWriteVertexData(HxData* data);
 
     bool addEdgeData(HxData* data);
     void removeEdgeData(HxData* data);
     void writeEdgeData(HxData* data);
+    void scheduleWriteEdgeData(HxData* data);
+
+    void setExportRate(HxData* data, double rate);
+
+    QString manifestPath();
+    void writeManifest();
      
     QString vertexSelectionPath();
     void readVertexSelection();
     const std::vector<bool>& vertexSelection() const;
+    std::vector<bool> vertexSelection(HxSpatialGraph* graph) const;
+    const TableSelections& vertexTableSelections() const;
+    void writeVertexSelection(const std::vector<bool>& selection);
 
     QString edgeSelectionPath();
     void readEdgeSelection();
     const std::vector<bool>& edgeSelection() const;
+    std::vector<bool> edgeSelection(HxSpatialGraph* graph) const;
+    const TableSelections& edgeTableSelections() const;
+    void writeEdgeSelection(const std::vector<bool>& selection);
+
+    void setPropagation(HxSpatialGraph* graph, Propagation propagation);
+    Propagation propagation() const;
+
+    void setExpansion(HxSpatialGraph* graph, Expansion expansion, int nhops);
+    Expansion expansion() const;
 
     QString vertexColormapPath();
+    QString vertexColorsPath();
     bool readVertexColormap();
     bool writeVertexColormap(HxConnection& connection);
+    bool pushVertexColormap(HxConnection& connection);
 
     QString edgeColormapPath();
+    QString edgeColorsPath();
     bool readEdgeColormap();
     bool writeEdgeColormap(HxConnection& connection);
+    bool pushEdgeColormap(HxConnection& connection);
 
     CodaProcess* process();
     QString dataDirectory();
 
+    const GraphAdjacency& adjacency(HxSpatialGraph* graph);
+    void invalidateAdjacency(HxSpatialGraph* graph);
+    std::uint64_t graphStamp(HxSpatialGraph* graph);
+
+    void fireAttributeChange(HxSpatialGraph* graph);
+    bool isChangingAttributes() const;
+
+    void setParentGraph(HxSpatialGraph* child, HxSpatialGraph* parent);
+    void removeParentGraph(HxSpatialGraph* child);
+
 protected:
 
     void updateSelectionWatch();
 
+    void readExportRequests();
+
     void loadCodaSelection(
         std::vector<bool>& selection, 
-        McHandle<HxSpreadSheet>& spreadsheet,
+        TableSelections& table_selections,
         const QString path
     );
 
+    void storeVertexSelection(const std::vector<bool>& selection);
+    void storeEdgeSelection(const std::vector<bool>& selection);
+
+    bool saveCodaSelection(
+        const std::vector<bool>& selection,
+        const TableSelections& table_selections,
+        const QString path
+    );
+
+    void propagateVertexSelection();
+    void propagateEdgeSelection();
+
+    bool expandVertexSelection(std::vector<bool>& selection);
+    bool expandEdgeSelection(std::vector<bool>& selection);
+
+    bool importItemColors(HxSpatialGraph::ItemType type);
+
 protected slots:
 
     void on_watcher_fileChanged(const QString& path);
@@ -103,6 +204,17 @@ protected:
     void rescheduleReadVertexColormap();
     void rescheduleReadEdgeColormap();
 
+    bool isOrphaned(HxSpatialGraph* graph) const;
+    void pruneGraphs();
+
+    bool selectionFromChild(
+        std::vector<bool>& parent_selection,
+        HxSpatialGraph* parent,
+        HxSpatialGraph::ItemType type,
+        const std::vector<bool>& selection,
+        int depth = 8
+    ) const;
+
 signals:
 
     void edgeSelectionChanged();
@@ -133,14 +245,66 @@ private:
     /// Maps a path to the associated Amira data object.
     QMap<QString, McHandle<HxData>> m_path_to_data;
 
-    /// The current vertex selection in Coda.
+    /// Maps a path to the throttle limiting the write rate of
+    /// the associated Amira data object.
+    QMap<QString, ExportThrottle*> m_path_to_throttle;
+
+    /// The paths Coda requested. Only these data objects are written, 
+    /// the others are only described in the manifest.
+    QSet<QString> m_exported_paths;
+
+    /// The cached topology of a spatialgraph filtered or selected by the
+    /// modules. The handle keeps the address of the graph from being reused
+    /// by another graph while the entry exists.
+    struct GraphIndex
+    {
+        McHandle<HxSpatialGraph> graph;
+
+        /// The modification stamp of the graph, see graphStamp().
+        std::uint64_t stamp = 0;
+
+        /// The adjacency index, which is built on demand.
+        QSharedPointer<GraphAdjacency> adjacency;
+    };
+
+    /// The indices of the spatialgraphs and the last stamp handed out.
+    QMap<HxSpatialGraph*, GraphIndex> m_graph_indices;
+    std::uint64_t m_last_graph_stamp;
+
+    /// A filtered spatialgraph and the graph it has been filtered from.
+    /// The handle of the child keeps its address from being reused while
+    /// the entry exists, see pruneGraphs().
+    struct GraphParent
+    {
+        McHandle<HxSpatialGraph> child;
+        McHandle<HxSpatialGraph> parent;
+    };
+
+    /// Maps a filtered spatialgraph to the graph it has been filtered from.
+    QMap<HxSpatialGraph*, GraphParent> m_graph_parents;
+
+    /// The spatialgraph whose topology is used to derive the edge
+    /// selection from the vertex selection or vice versa.
+    McHandle<HxSpatialGraph> m_propagation_graph;
+    Propagation m_propagation;
+
+    /// The spatialgraph along which the selections are expanded.
+    McHandle<HxSpatialGraph> m_expansion_graph;
+    Expansion m_expansion;
+    int m_expansion_hops;
+
+    /// The current vertex selection in Coda and the selection
+    /// before it has been expanded.
     std::vector<bool> m_coda_vertex_selection;
-    McHandle<HxSpreadSheet> m_coda_vertex_selection_csv;
+    std::vector<bool> m_coda_vertex_selection_seed;
+    TableSelections m_coda_vertex_table_selections;
     QTimer* m_coda_vertex_selection_timer;
 
-    /// The current edge selection in Coda.
+    /// The current edge selection in Coda and the selection
+    /// before it has been expanded.
     std::vector<bool> m_coda_edge_selection;
-    McHandle<HxSpreadSheet> m_coda_edge_selection_csv;
+    std::vector<bool> m_coda_edge_selection_seed;
+    TableSelections m_coda_edge_table_selections;
     QTimer* m_coda_edge_selection_timer;
 
     /// The current vertex colormap used in Coda.
@@ -150,6 +314,15 @@ private:
     /// The current edge colormap used in Coda.
     McHandle<HxColormap256> m_coda_edge_colormap;
     QTimer* m_coda_edge_colormap_timer;
+
+    /// The hashes of the colormaps last pushed to Coda.
+    std::uint64_t m_amira_vertex_colormap_hash;
+    std::uint64_t m_amira_edge_colormap_hash;
+
+    /// True while a change of the attributes written by hxcoda is
+    /// propagated, e.g. the colors imported from Coda or a selection
+    /// attribute. The topology and the exported data did not change then.
+    bool m_is_changing_attributes;
 };
 
 
@@ -161,11 +334,13 @@ std::shared_ptr<Coda> theCoda();
 
 
 /**
- * Select all rows given in the selection mask.
+ * Select all rows given in the selection mask. Tables with an entry in
+ * *table_selections* use their own selection instead.
  */
 void select(
     HxSpreadSheet* input, 
-    const std::vector<bool>& selection
+    const std::vector<bool>& selection,
+    const TableSelections& table_selections = TableSelections()
 );
 
 
@@ -195,6 +370,56 @@ void filterEdges(
 );
 
 
+/**
+ * Filters the spatialgraph with the vertex selection *vertex_selection* and 
+ * the edge selection *edge_selection* at once.
+ *
+ * The subgraphs of filterVertices() and filterEdges() are combined, either 
+ * by intersection or by *is_union*. This is done in a single traversal and 
+ * only one subgraph is created.
+ */
+void filterGraph(
+    HxSpatialGraph* result,
+    HxSpatialGraph* input,
+    const std::vector<bool>& vertex_selection,
+    const std::vector<bool>& edge_selection,
+    bool is_union
+);
+
+
+/// The name of the vertex and edge attributes written by markVertices()
+/// and markEdges().
+extern const char* const SELECTION_ATTRIBUTE;
+
+
+/**
+ * Writes the vertex selection mask *selection* into the integer vertex
+ * attribute SELECTION_ATTRIBUTE of the spatialgraph *graph*. The edge
+ * attribute with the same name marks the edges with both endpoints
+ * selected, like filterVertices().
+ *
+ * Selected items have the value 1, all others 0. The topology of the
+ * graph is not changed, so a renderer can hide or dim the unselected
+ * items with a colormap without rebuilding the geometry.
+ */
+void markVertices(
+    HxSpatialGraph* graph,
+    const std::vector<bool>& selection
+);
+
+
+/**
+ * Writes the edge selection mask *selection* into the integer edge
+ * attribute SELECTION_ATTRIBUTE of the spatialgraph *graph*. The vertex
+ * attribute with the same name marks the endpoints of the selected edges,
+ * like filterEdges().
+ */
+void markEdges(
+    HxSpatialGraph* graph,
+    const std::vector<bool>& selection
+);
+
+
 /**
  * Filter a regular field given a selection mask.
  */
@@ -205,6 +430,77 @@ void filter(
 );
 
 
+/**
+ * The state kept by a filter module between two runs of filter(), which
+ * allows to update the result incrementally when the selection changes.
+ * 
+ * The cache must be invalidated when the input field is touched.
+ */
+struct LabelFilterCache
+{
+    /// The per-label voxel index of the input field.
+    LabelIndex index;
+
+    /// The selection the result has been filtered with.
+    std::vector<bool> applied_selection;
+
+    /// True if the result still contains the input filtered with
+    /// *applied_selection*.
+    bool valid = false;
+
+    void invalidate();
+};
+
+
+/**
+ * Filter a regular field given a selection mask.
+ * 
+ * If the result has been filtered before with the same *cache*, only the
+ * voxels of labels which were added to or removed from the selection are
+ * updated, so the cost scales with the change instead of the volume size.
+ */
+void filter(
+    HxUniformLabelField3* result, 
+    HxUniformLabelField3* input, 
+    const std::vector<bool>& selection,
+    LabelFilterCache& cache
+);
+
+
+/**
+ * Filters a label field like filter(), but numbers the remaining labels 
+ * consecutively starting at 1 and stores them in the smallest integer type
+ * that can hold them, e.g. ``uint8`` if at most 255 labels remain.
+ * 
+ * The spreadsheet *mapping* receives one row per new label with the columns
+ * ``label`` and ``original_label``. Returns false if the primitive type of
+ * the input is not supported.
+ */
+bool filterCompact(
+    HxUniformLabelField3* result, 
+    HxUniformLabelField3* input, 
+    const std::vector<bool>& selection,
+    HxSpreadSheet* mapping
+);
+
+
+/**
+ * Creates a label colormap which hides all labels that are not part of the
+ * selection mask by setting their alpha to zero. The colors of the selected
+ * labels are taken from the *base* colormap.
+ * 
+ * The colormap has one entry per label, so the cost is independent of the
+ * size of the label field. An empty selection shows all labels. The
+ * background label 0 is always hidden.
+ */
+void colormapMask(
+    HxColormap256* result,
+    HxColormap* base,
+    const std::vector<bool>& selection,
+    int nlabels
+);
+
+
 /**
  * Returns the colormap attached to the vertex data of the
  * HxConnection object.
@@ -233,6 +529,18 @@ void colormapToSpreadSheet(
 );
 
 
+/**
+ * Samples the colormap into a compact binary representation, which can be
+ * pushed to Coda without formatting a CSV file.
+ *
+ * The data starts with the magic ``AMIRACMP``, followed by the number of
+ * colors (uint32) and the coordinates of the first and last color (float32).
+ * Then the packed RGBA colors follow (uint32 each, red in the lowest byte).
+ * All values are little endian.
+ */
+QByteArray colormapToBinary(HxColormap* colormap);
+
+
 /**
  * Reads a colormap from a spreadsheet. 
  */
@@ -0,0 +1,102 @@
+// STL
+#include <algorithm>
+#include <cmath>
+
+// Local
+#include <hxcoda/internal/ExportThrottle.h>
+
+
+namespace coda
+{
+
+
+ExportThrottle::ExportThrottle(std::function<void()> write, QObject* parent)
+    : QObject(parent)
+    , m_write(write)
+    , m_timer(nullptr)
+    , m_max_rate(2.0)
+    , m_pending(false)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &ExportThrottle::on_timer_timeout);
+}
+
+
+ExportThrottle::~ExportThrottle()
+{}
+
+
+void ExportThrottle::setMaxRate(double rate)
+{
+    m_max_rate = std::max(0.0, rate);
+
+    // Without a limit, there is no reason to hold back a pending write.
+    if(m_max_rate == 0.0 && m_pending)
+    {
+        flush();
+    }
+}
+
+
+double ExportThrottle::maxRate() const
+{
+    return m_max_rate;
+}
+
+
+void ExportThrottle::request()
+{
+    // Still cooling down from the last write. Remember that the data
+    // changed and write the newest state once the cooldown expires.
+    if(m_timer->isActive())
+    {
+        m_pending = true;
+        return;
+    }
+
+    write();
+}
+
+
+void ExportThrottle::flush()
+{
+    m_timer->stop();
+    if(m_pending)
+    {
+        write();
+    }
+}
+
+
+bool ExportThrottle::isPending() const
+{
+    return m_pending;
+}
+
+
+void ExportThrottle::on_timer_timeout()
+{
+    if(m_pending)
+    {
+        write();
+    }
+}
+
+
+void ExportThrottle::write()
+{
+    m_pending = false;
+    m_write();
+
+    // The cooldown starts after the write completed, so that slow writes
+    // cannot pile up.
+    if(m_max_rate > 0.0)
+    {
+        const int interval = static_cast<int>(std::ceil(1000.0/m_max_rate));
+        m_timer->start(interval);
+    }
+}
+
+
+} // namespace coda
\ No newline at end of file
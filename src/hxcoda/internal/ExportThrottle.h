@@ -0,0 +1,68 @@
+#pragma once
+
+// STL
+#include <functional>
+
+// Qt
+#include <QObject>
+#include <QTimer>
+
+
+namespace coda
+{
+
+
+/**
+ * @brief The ExportThrottle class
+ *
+ * Limits how often a synchronized data object is written to the shared
+ * directory with Coda.
+ *
+ * The first request is written immediately. Requests arriving during the
+ * cooldown period after a write are collapsed into a single pending write,
+ * which is performed once the cooldown expires. Since the write callback
+ * serializes the data object at the time it is called, only the newest
+ * state is exported (last write wins) and Coda sees a steady update rate
+ * instead of one reload per change.
+ */
+class ExportThrottle : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit ExportThrottle(std::function<void()> write, QObject* parent = nullptr);
+    virtual ~ExportThrottle();
+
+    void setMaxRate(double rate);
+    double maxRate() const;
+
+    void request();
+    void flush();
+    bool isPending() const;
+
+protected slots:
+
+    void on_timer_timeout();
+
+private:
+
+    void write();
+
+private:
+
+    /// Serializes the current state of the data object.
+    std::function<void()> m_write;
+
+    /// The cooldown timer started after each write.
+    QTimer* m_timer;
+
+    /// The maximum number of writes per second. Zero disables the throttle.
+    double m_max_rate;
+
+    /// True if a change arrived during the cooldown period.
+    bool m_pending;
+};
+
+
+} // namespace coda
\ No newline at end of file
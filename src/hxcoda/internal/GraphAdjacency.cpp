@@ -0,0 +1,215 @@
+// STL
+#include <algorithm>
+#include <cstdint>
+
+// Local
+#include <hxcoda/internal/GraphAdjacency.h>
+#include <hxcoda/internal/Parallel.h>
+
+
+namespace coda
+{
+
+
+GraphAdjacency::GraphAdjacency()
+    : m_built(false)
+    , m_sources()
+    , m_targets()
+    , m_offsets()
+    , m_incident_edges()
+    , m_components()
+{}
+
+
+void GraphAdjacency::clear()
+{
+    m_built = false;
+    m_sources.clear();
+    m_targets.clear();
+    m_offsets.clear();
+    m_incident_edges.clear();
+    m_components.clear();
+}
+
+
+bool GraphAdjacency::isEmpty() const
+{
+    return !m_built;
+}
+
+
+/**
+ * Builds the index of the spatialgraph *graph*. The endpoints are gathered
+ * in parallel, the CSR arrays are then filled with a counting sort.
+ */
+void GraphAdjacency::build(HxSpatialGraph* graph)
+{
+    const std::int64_t nvertices = graph->getNumVertices();
+    const std::int64_t nedges = graph->getNumEdges();
+
+    m_sources.resize(nedges);
+    m_targets.resize(nedges);
+
+    parallelFor(0, nedges, 4096, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t iedge = first; iedge < last; ++iedge)
+        {
+            const int isource = graph->getEdgeSource(static_cast<int>(iedge));
+            const int itarget = graph->getEdgeTarget(static_cast<int>(iedge));
+            m_sources[iedge] = (0 <= isource && isource < nvertices) ? isource : -1;
+            m_targets[iedge] = (0 <= itarget && itarget < nvertices) ? itarget : -1;
+        }
+    });
+
+    // Count the degrees.
+    m_offsets.assign(nvertices + 1, 0);
+    for(std::int64_t iedge = 0; iedge < nedges; ++iedge)
+    {
+        const int isource = m_sources[iedge];
+        const int itarget = m_targets[iedge];
+        if(isource >= 0)
+        {
+            ++m_offsets[isource + 1];
+        }
+        if(itarget >= 0 && itarget != isource)
+        {
+            ++m_offsets[itarget + 1];
+        }
+    }
+    for(std::int64_t ivertex = 0; ivertex < nvertices; ++ivertex)
+    {
+        m_offsets[ivertex + 1] += m_offsets[ivertex];
+    }
+
+    // Fill the incident edges. Visiting the edges in order keeps
+    // the lists sorted.
+    m_incident_edges.resize(m_offsets[nvertices]);
+    std::vector<std::int64_t> next(m_offsets.begin(), m_offsets.end() - 1);
+    for(std::int64_t iedge = 0; iedge < nedges; ++iedge)
+    {
+        const int isource = m_sources[iedge];
+        const int itarget = m_targets[iedge];
+        if(isource >= 0)
+        {
+            m_incident_edges[next[isource]++] = static_cast<int>(iedge);
+        }
+        if(itarget >= 0 && itarget != isource)
+        {
+            m_incident_edges[next[itarget]++] = static_cast<int>(iedge);
+        }
+    }
+
+    m_components.clear();
+    m_built = true;
+}
+
+
+/**
+ * Returns true if the index has been built for a graph with the
+ * same number of vertices and edges as *graph*.
+ */
+bool GraphAdjacency::matches(HxSpatialGraph* graph) const
+{
+    return m_built
+        && numVertices() == graph->getNumVertices()
+        && numEdges() == graph->getNumEdges();
+}
+
+
+std::int64_t GraphAdjacency::numVertices() const
+{
+    return m_offsets.empty() ? 0 : static_cast<std::int64_t>(m_offsets.size()) - 1;
+}
+
+
+std::int64_t GraphAdjacency::numEdges() const
+{
+    return static_cast<std::int64_t>(m_sources.size());
+}
+
+
+const std::vector<int>& GraphAdjacency::sources() const
+{
+    return m_sources;
+}
+
+
+const std::vector<int>& GraphAdjacency::targets() const
+{
+    return m_targets;
+}
+
+
+std::int64_t GraphAdjacency::degree(std::int64_t ivertex) const
+{
+    return m_offsets[ivertex + 1] - m_offsets[ivertex];
+}
+
+
+const int* GraphAdjacency::incidentEdges(std::int64_t ivertex) const
+{
+    return m_incident_edges.data() + m_offsets[ivertex];
+}
+
+
+/**
+ * Returns the connected component of each vertex. The components are
+ * computed once with a union-find over the edges and cached until the
+ * index is rebuilt.
+ */
+const std::vector<int>& GraphAdjacency::components() const
+{
+    const std::int64_t nvertices = numVertices();
+    const std::int64_t nedges = numEdges();
+    if(static_cast<std::int64_t>(m_components.size()) == nvertices)
+    {
+        return m_components;
+    }
+
+    // Union by size with path halving.
+    std::vector<int> parents(nvertices);
+    std::vector<int> sizes(nvertices, 1);
+    for(std::int64_t ivertex = 0; ivertex < nvertices; ++ivertex)
+    {
+        parents[ivertex] = static_cast<int>(ivertex);
+    }
+
+    auto find = [&parents](int ivertex) {
+        while(parents[ivertex] != ivertex)
+        {
+            parents[ivertex] = parents[parents[ivertex]];
+            ivertex = parents[ivertex];
+        }
+        return ivertex;
+    };
+
+    for(std::int64_t iedge = 0; iedge < nedges; ++iedge)
+    {
+        if(m_sources[iedge] < 0 || m_targets[iedge] < 0)
+        {
+            continue;
+        }
+
+        int iroot = find(m_sources[iedge]);
+        int jroot = find(m_targets[iedge]);
+        if(iroot == jroot)
+        {
+            continue;
+        }
+        if(sizes[iroot] < sizes[jroot])
+        {
+            std::swap(iroot, jroot);
+        }
+        parents[jroot] = iroot;
+        sizes[iroot] += sizes[jroot];
+    }
+
+    m_components.resize(nvertices);
+    for(std::int64_t ivertex = 0; ivertex < nvertices; ++ivertex)
+    {
+        m_components[ivertex] = find(static_cast<int>(ivertex));
+    }
+    return m_components;
+}
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// ZIB
+#include <hxspatialgraph/internal/HxSpatialGraph.h>
+
+
+namespace coda
+{
+
+
+/**
+ * @brief The GraphAdjacency class
+ *
+ * A flat copy of the topology of a spatialgraph: The source and target
+ * vertex of every edge and the incident edges of every vertex in CSR form.
+ *
+ * The graph API has to be queried edge by edge. With the flat arrays, the
+ * filters and the graph-aware selection logic run over contiguous memory
+ * instead. The index must be rebuilt when the graph is touched, see
+ * Coda::adjacency().
+ */
+class GraphAdjacency
+{
+public:
+
+    GraphAdjacency();
+
+    void clear();
+    bool isEmpty() const;
+
+    void build(HxSpatialGraph* graph);
+    bool matches(HxSpatialGraph* graph) const;
+
+    std::int64_t numVertices() const;
+    std::int64_t numEdges() const;
+
+    const std::vector<int>& sources() const;
+    const std::vector<int>& targets() const;
+
+    std::int64_t degree(std::int64_t ivertex) const;
+    const int* incidentEdges(std::int64_t ivertex) const;
+
+    const std::vector<int>& components() const;
+
+private:
+
+    /// True if the index has been built.
+    bool m_built;
+
+    /// The source and target vertex of each edge. Invalid endpoints
+    /// are stored as -1.
+    std::vector<int> m_sources;
+    std::vector<int> m_targets;
+
+    /// The incident edges of vertex *i* are
+    /// ``m_incident_edges[m_offsets[i]:m_offsets[i+1]]`` in ascending order.
+    /// A loop is listed once. The offsets are 64 bit, since every edge is
+    /// listed twice.
+    std::vector<std::int64_t> m_offsets;
+    std::vector<int> m_incident_edges;
+
+    /// The connected component of each vertex, identified by one of its 
+    /// vertices. Computed on the first call of components().
+    mutable std::vector<int> m_components;
+};
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,267 @@
+// STL
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+// Local
+#include <hxcoda/internal/GraphSelection.h>
+#include <hxcoda/internal/Parallel.h>
+
+
+namespace coda
+{
+
+
+/**
+ * Calls *f(first, last)* in parallel for blocks of ``[0, n)`` starting at
+ * multiples of 64 items. std::vector<bool> packs the bits into words of at
+ * most 64 bits, so no two threads ever write to the same word and the bits
+ * can be written without atomics.
+ */
+template<typename Function>
+static void parallelForWords(std::int64_t n, Function f)
+{
+    const std::int64_t word_size = 64;
+    const std::int64_t nwords = (n + word_size - 1)/word_size;
+
+    parallelFor(0, nwords, 1024, [&](std::int64_t wfirst, std::int64_t wlast) {
+        f(wfirst*word_size, std::min(n, wlast*word_size));
+    });
+}
+
+
+void selectInducedEdges(
+    std::vector<bool>& edges,
+    const GraphAdjacency& adjacency,
+    const std::vector<bool>& vertices
+) {
+    const std::vector<int>& sources = adjacency.sources();
+    const std::vector<int>& targets = adjacency.targets();
+    const std::int64_t nedges = adjacency.numEdges();
+
+    edges.resize(nedges);
+    parallelForWords(nedges, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t iedge = first; iedge < last; ++iedge)
+        {
+            const int isource = sources[iedge];
+            const int itarget = targets[iedge];
+            edges[iedge] = isource >= 0 && itarget >= 0 && vertices[isource] && vertices[itarget];
+        }
+    });
+}
+
+
+void selectIncidentEdges(
+    std::vector<bool>& edges,
+    const GraphAdjacency& adjacency,
+    const std::vector<bool>& vertices
+) {
+    const std::vector<int>& sources = adjacency.sources();
+    const std::vector<int>& targets = adjacency.targets();
+    const std::int64_t nedges = adjacency.numEdges();
+
+    edges.resize(nedges);
+    parallelForWords(nedges, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t iedge = first; iedge < last; ++iedge)
+        {
+            const int isource = sources[iedge];
+            const int itarget = targets[iedge];
+            edges[iedge] = (isource >= 0 && vertices[isource]) || (itarget >= 0 && vertices[itarget]);
+        }
+    });
+}
+
+
+/**
+ * A vertex is selected if one of its incident edges is selected. The vertices
+ * gather from their incident edges in the adjacency index, so each thread
+ * only writes to its own range of vertices and no merge is needed.
+ */
+void selectEndpoints(
+    std::vector<bool>& vertices,
+    const GraphAdjacency& adjacency,
+    const std::vector<bool>& edges
+) {
+    const std::int64_t nvertices = adjacency.numVertices();
+
+    vertices.resize(nvertices);
+    parallelForWords(nvertices, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t ivertex = first; ivertex < last; ++ivertex)
+        {
+            const int* incident = adjacency.incidentEdges(ivertex);
+            const std::int64_t degree = adjacency.degree(ivertex);
+
+            bool selected = false;
+            for(std::int64_t i = 0; i < degree && !selected; ++i)
+            {
+                selected = edges[incident[i]];
+            }
+            vertices[ivertex] = selected;
+        }
+    });
+}
+
+
+/**
+ * A level-synchronous, direction-optimizing BFS. As long as the frontier is
+ * small, its vertices push to their unselected neighbours. Once it grows, the
+ * unselected vertices check in parallel if one of their neighbours is in the
+ * frontier. In that step, each thread only writes to its own range of vertices,
+ * so no atomics are needed per vertex.
+ */
+void expandNeighbourhood(
+    std::vector<bool>& vertices,
+    const GraphAdjacency& adjacency,
+    int nhops
+) {
+    const std::vector<int>& sources = adjacency.sources();
+    const std::vector<int>& targets = adjacency.targets();
+    const std::int64_t nvertices = adjacency.numVertices();
+
+    // Use the bottom-up step if the frontier holds more vertices.
+    const std::int64_t max_push_frontier = std::max<std::int64_t>(1024, nvertices/32);
+
+    auto neighbour = [&](int iedge, std::int64_t ivertex) {
+        return sources[iedge] == ivertex ? targets[iedge] : sources[iedge];
+    };
+
+    // The frontier as mask and, if it is small, as list.
+    std::vector<bool> frontier = vertices;
+    std::vector<bool> next(nvertices);
+    std::vector<int> frontier_list;
+    bool is_listed = true;
+    for(std::int64_t ivertex = 0; ivertex < nvertices && is_listed; ++ivertex)
+    {
+        if(vertices[ivertex])
+        {
+            frontier_list.push_back(static_cast<int>(ivertex));
+            is_listed = static_cast<std::int64_t>(frontier_list.size()) <= max_push_frontier;
+        }
+    }
+
+    for(int ihop = 0; ihop < nhops; ++ihop)
+    {
+        // Top-down step.
+        if(is_listed)
+        {
+            std::vector<int> next_list;
+            for(const int ivertex : frontier_list)
+            {
+                frontier[ivertex] = false;
+
+                const int* incident = adjacency.incidentEdges(ivertex);
+                const std::int64_t degree = adjacency.degree(ivertex);
+                for(std::int64_t i = 0; i < degree; ++i)
+                {
+                    const int ineighbour = neighbour(incident[i], ivertex);
+                    if(ineighbour >= 0 && !vertices[ineighbour])
+                    {
+                        vertices[ineighbour] = true;
+                        next_list.push_back(ineighbour);
+                    }
+                }
+            }
+            for(const int ivertex : next_list)
+            {
+                frontier[ivertex] = true;
+            }
+
+            frontier_list.swap(next_list);
+            is_listed = static_cast<std::int64_t>(frontier_list.size()) <= max_push_frontier;
+            if(frontier_list.empty())
+            {
+                break;
+            }
+            continue;
+        }
+
+        // Bottom-up step.
+        std::atomic<std::int64_t> nnext(0);
+        parallelForWords(nvertices, [&](std::int64_t first, std::int64_t last) {
+            std::int64_t block_nnext = 0;
+            for(std::int64_t ivertex = first; ivertex < last; ++ivertex)
+            {
+                next[ivertex] = false;
+                if(vertices[ivertex])
+                {
+                    continue;
+                }
+
+                const int* incident = adjacency.incidentEdges(ivertex);
+                const std::int64_t degree = adjacency.degree(ivertex);
+                for(std::int64_t i = 0; i < degree; ++i)
+                {
+                    const int ineighbour = neighbour(incident[i], ivertex);
+                    if(ineighbour >= 0 && frontier[ineighbour])
+                    {
+                        next[ivertex] = true;
+                        ++block_nnext;
+                        break;
+                    }
+                }
+            }
+            nnext += block_nnext;
+        });
+
+        // Stop early if the selection covers the whole components.
+        if(nnext == 0)
+        {
+            break;
+        }
+
+        parallelForWords(nvertices, [&](std::int64_t first, std::int64_t last) {
+            for(std::int64_t ivertex = first; ivertex < last; ++ivertex)
+            {
+                if(next[ivertex])
+                {
+                    vertices[ivertex] = true;
+                }
+            }
+        });
+        frontier.swap(next);
+
+        // Switch back to the top-down step if the frontier shrinks.
+        is_listed = nnext <= max_push_frontier;
+        if(is_listed)
+        {
+            frontier_list.clear();
+            for(std::int64_t ivertex = 0; ivertex < nvertices; ++ivertex)
+            {
+                if(frontier[ivertex])
+                {
+                    frontier_list.push_back(static_cast<int>(ivertex));
+                }
+            }
+        }
+    }
+}
+
+
+void expandComponents(
+    std::vector<bool>& vertices,
+    const GraphAdjacency& adjacency
+) {
+    const std::vector<int>& components = adjacency.components();
+    const std::int64_t nvertices = adjacency.numVertices();
+
+    // Mark the components touching the selection. A component is
+    // identified by one of its vertices.
+    std::vector<bool> touched(nvertices, false);
+    for(std::int64_t ivertex = 0; ivertex < nvertices; ++ivertex)
+    {
+        if(vertices[ivertex])
+        {
+            touched[components[ivertex]] = true;
+        }
+    }
+
+    parallelForWords(nvertices, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t ivertex = first; ivertex < last; ++ivertex)
+        {
+            vertices[ivertex] = touched[components[ivertex]];
+        }
+    });
+}
+
+
+} // namespace coda
\ No newline at end of file
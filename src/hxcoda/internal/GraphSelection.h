@@ -0,0 +1,70 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// Local
+#include <hxcoda/internal/GraphAdjacency.h>
+
+
+namespace coda
+{
+
+
+/**
+ * Selects the edges with both endpoints in the vertex selection *vertices*.
+ * *edges* is resized to the number of edges in the graph.
+ *
+ * This is the edge set of the subgraph induced by the vertex selection.
+ */
+void selectInducedEdges(
+    std::vector<bool>& edges,
+    const GraphAdjacency& adjacency,
+    const std::vector<bool>& vertices
+);
+
+
+/**
+ * Selects the edges with at least one endpoint in the vertex selection
+ * *vertices*. *edges* is resized to the number of edges in the graph.
+ */
+void selectIncidentEdges(
+    std::vector<bool>& edges,
+    const GraphAdjacency& adjacency,
+    const std::vector<bool>& vertices
+);
+
+
+/**
+ * Selects the endpoints of the edges in the edge selection *edges*.
+ * *vertices* is resized to the number of vertices in the graph.
+ */
+void selectEndpoints(
+    std::vector<bool>& vertices,
+    const GraphAdjacency& adjacency,
+    const std::vector<bool>& edges
+);
+
+
+/**
+ * Adds all vertices within *nhops* edges of the vertex selection *vertices*
+ * to the selection.
+ */
+void expandNeighbourhood(
+    std::vector<bool>& vertices,
+    const GraphAdjacency& adjacency,
+    int nhops
+);
+
+
+/**
+ * Adds all vertices in the connected components touching the vertex
+ * selection *vertices* to the selection.
+ */
+void expandComponents(
+    std::vector<bool>& vertices,
+    const GraphAdjacency& adjacency
+);
+
+
+} // namespace coda
\ No newline at end of file
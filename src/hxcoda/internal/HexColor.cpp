@@ -0,0 +1,103 @@
+// STL
+#include <algorithm>
+
+// Local
+#include <hxcoda/internal/HexColor.h>
+#include <hxcoda/internal/Parallel.h>
+
+
+namespace coda
+{
+
+
+/// The hex digits used to encode a color.
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+
+/**
+ * Maps an ASCII character to the value of the hex digit. Characters which
+ * are no hex digits are mapped to zero.
+ */
+struct HexDecodeTable
+{
+    unsigned char values[256];
+
+    HexDecodeTable()
+    {
+        std::fill(values, values + 256, 0);
+        for(int i = 0; i < 10; ++i)
+        {
+            values['0' + i] = static_cast<unsigned char>(i);
+        }
+        for(int i = 0; i < 6; ++i)
+        {
+            values['a' + i] = static_cast<unsigned char>(10 + i);
+            values['A' + i] = static_cast<unsigned char>(10 + i);
+        }
+    }
+};
+
+static const HexDecodeTable HEX_DECODE_TABLE;
+
+
+void rgbaToHex(char* hex, const float rgba[4])
+{
+    hex[0] = '#';
+    for(int ichannel = 0; ichannel < 4; ++ichannel)
+    {
+        // Round, so that decoding and encoding again gives the same digits.
+        const int value = std::max(0, std::min(255, static_cast<int>(255.0f*rgba[ichannel] + 0.5f)));
+        hex[1 + 2*ichannel] = HEX_DIGITS[value >> 4];
+        hex[2 + 2*ichannel] = HEX_DIGITS[value & 0xF];
+    }
+    hex[9] = '\0';
+}
+
+
+bool rgbaFromHex(float rgba[4], const char* hex)
+{
+    rgba[0] = 1.0f;
+    rgba[1] = 1.0f;
+    rgba[2] = 1.0f;
+    rgba[3] = 1.0f;
+
+    if(hex == nullptr || hex[0] != '#')
+    {
+        return false;
+    }
+
+    // Decode the complete pairs of hex digits, i.e. red, green,
+    // blue and alpha.
+    const unsigned char* digits = reinterpret_cast<const unsigned char*>(hex + 1);
+    for(int ichannel = 0; ichannel < 4 && digits[0] && digits[1]; ++ichannel, digits += 2)
+    {
+        const int value = 16*HEX_DECODE_TABLE.values[digits[0]] + HEX_DECODE_TABLE.values[digits[1]];
+        rgba[ichannel] = static_cast<float>(value)/255.0f;
+    }
+    return true;
+}
+
+
+void rgbaToHexColumn(char* hex, const float* rgba, std::int64_t ncolors)
+{
+    parallelFor(0, ncolors, 16384, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t icolor = first; icolor < last; ++icolor)
+        {
+            rgbaToHex(hex + HEX_RGBA_SIZE*icolor, rgba + 4*icolor);
+        }
+    });
+}
+
+
+void rgbaFromHexColumn(float* rgba, const char* hex, std::int64_t ncolors)
+{
+    parallelFor(0, ncolors, 16384, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t icolor = first; icolor < last; ++icolor)
+        {
+            rgbaFromHex(rgba + 4*icolor, hex + HEX_RGBA_SIZE*icolor);
+        }
+    });
+}
+
+
+} // namespace coda
\ No newline at end of file
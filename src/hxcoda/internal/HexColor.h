@@ -0,0 +1,46 @@
+#pragma once
+
+// STL
+#include <cstdint>
+
+
+namespace coda
+{
+
+
+/// The size of a hex coded color ``#rrggbbaa`` including the terminating
+/// zero. The colors of a column are stored with this stride.
+const int HEX_RGBA_SIZE = 10;
+
+
+/**
+ * Converts a float RGBA color into the zero padded hex-coded string
+ * representation ``#rrggbbaa``. *hex* must have room for HEX_RGBA_SIZE
+ * characters.
+ */
+void rgbaToHex(char* hex, const float rgba[4]);
+
+
+/**
+ * Extracts a color from a hex coded RGBA value. Missing components
+ * are set to 1.
+ */
+bool rgbaFromHex(float rgba[4], const char* hex);
+
+
+/**
+ * Encodes the *ncolors* colors *rgba* into *hex* with the stride
+ * HEX_RGBA_SIZE. The colors are encoded in parallel.
+ */
+void rgbaToHexColumn(char* hex, const float* rgba, std::int64_t ncolors);
+
+
+/**
+ * Decodes the *ncolors* zero terminated colors in *hex*, which are stored
+ * with the stride HEX_RGBA_SIZE, into *rgba*. The colors are decoded in
+ * parallel.
+ */
+void rgbaFromHexColumn(float* rgba, const char* hex, std::int64_t ncolors);
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,201 @@
+// STL
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+// Qt
+#include <QFile>
+
+// Local
+#include <hxcoda/internal/ItemColors.h>
+#include <hxcoda/internal/Parallel.h>
+
+
+namespace coda
+{
+
+
+const char* const RGBA_ATTRIBUTE = "coda_rgba";
+
+
+std::int64_t ItemColors::numItems() const
+{
+    return static_cast<std::int64_t>(indices.size());
+}
+
+
+void ItemColors::clear()
+{
+    palette.clear();
+    indices.clear();
+}
+
+
+/**
+ * Decodes the little endian unsigned integer with *nbytes* bytes at *data*.
+ */
+static std::uint64_t decodeLittleEndian(const unsigned char* data, int nbytes)
+{
+    std::uint64_t value = 0;
+    for(int ibyte = nbytes - 1; ibyte >= 0; --ibyte)
+    {
+        value = (value << 8) | data[ibyte];
+    }
+    return value;
+}
+
+
+bool readItemColors(ItemColors& colors, const QString& path)
+{
+    colors.clear();
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    // The header.
+    unsigned char header[24];
+    if(file.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header))
+    {
+        return false;
+    }
+    if(std::memcmp(header, "CODARGBA", 8) != 0)
+    {
+        return false;
+    }
+
+    const std::uint64_t npalette = decodeLittleEndian(header + 8, 4);
+    const int index_size = static_cast<int>(decodeLittleEndian(header + 12, 4));
+    const std::uint64_t nitems = decodeLittleEndian(header + 16, 8);
+
+    if(index_size != 1 && index_size != 2 && index_size != 4)
+    {
+        return false;
+    }
+    if(nitems > 0 && npalette == 0)
+    {
+        return false;
+    }
+    if(file.size() != static_cast<qint64>(sizeof(header) + 4*npalette + index_size*nitems))
+    {
+        return false;
+    }
+
+    // The palette.
+    std::vector<unsigned char> bytes(4*npalette);
+    if(file.read(reinterpret_cast<char*>(bytes.data()), bytes.size()) != static_cast<qint64>(bytes.size()))
+    {
+        return false;
+    }
+
+    colors.palette.resize(npalette);
+    for(std::uint64_t icolor = 0; icolor < npalette; ++icolor)
+    {
+        colors.palette[icolor] = static_cast<std::uint32_t>(decodeLittleEndian(&bytes[4*icolor], 4));
+    }
+
+    // The palette indices, widened in parallel.
+    bytes.resize(index_size*nitems);
+    if(file.read(reinterpret_cast<char*>(bytes.data()), bytes.size()) != static_cast<qint64>(bytes.size()))
+    {
+        colors.clear();
+        return false;
+    }
+
+    colors.indices.resize(nitems);
+    std::atomic<bool> is_valid(true);
+    parallelFor(0, static_cast<std::int64_t>(nitems), 65536, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t iitem = first; iitem < last; ++iitem)
+        {
+            const std::uint32_t index = static_cast<std::uint32_t>(
+                decodeLittleEndian(&bytes[index_size*iitem], index_size)
+            );
+            if(index >= npalette)
+            {
+                is_valid = false;
+                return;
+            }
+            colors.indices[iitem] = index;
+        }
+    });
+
+    if(!is_valid)
+    {
+        colors.clear();
+        return false;
+    }
+    return true;
+}
+
+
+bool colorsToAttribute(
+    HxSpatialGraph* graph,
+    HxSpatialGraph::ItemType type,
+    const ItemColors& colors
+) {
+    const std::int64_t nitems = type == HxSpatialGraph::VERTEX ? graph->getNumVertices() : graph->getNumEdges();
+    if(nitems != colors.numItems())
+    {
+        return false;
+    }
+
+    // Reuse the attribute written by a previous import.
+    auto attribute = dynamic_cast<EdgeVertexAttribute*>(graph->findAttribute(type, RGBA_ATTRIBUTE));
+    if(attribute && (attribute->primType() != McPrimType::MC_INT32 || attribute->nDataVar() != 1))
+    {
+        graph->deleteAttribute(attribute);
+        attribute = nullptr;
+    }
+    if(!attribute)
+    {
+        attribute = dynamic_cast<EdgeVertexAttribute*>(
+            graph->addAttribute(RGBA_ATTRIBUTE, type, McPrimType::MC_INT32, 1)
+        );
+    }
+    if(!attribute)
+    {
+        return false;
+    }
+
+    parallelFor(0, nitems, 65536, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t iitem = first; iitem < last; ++iitem)
+        {
+            const std::uint32_t rgba = colors.palette[colors.indices[iitem]];
+            *attribute->intDataAtIdx(static_cast<int>(iitem)) = static_cast<int>(rgba);
+        }
+    });
+    return true;
+}
+
+
+void colorsToColormap(HxColormap256* colormap, const ItemColors& colors)
+{
+    // Convert the palette to float colors.
+    const std::size_t npalette = colors.palette.size();
+    std::vector<float> palette_rgba(4*npalette);
+    for(std::size_t icolor = 0; icolor < npalette; ++icolor)
+    {
+        for(int ichannel = 0; ichannel < 4; ++ichannel)
+        {
+            const std::uint32_t value = (colors.palette[icolor] >> (8*ichannel)) & 0xFF;
+            palette_rgba[4*icolor + ichannel] = static_cast<float>(value)/255.0f;
+        }
+    }
+
+    const int ncolors = static_cast<int>(colors.numItems());
+    colormap->resize(ncolors);
+    colormap->setInterpolate(false);
+    colormap->setOutOfBoundsBehavior(HxColormap256::DEFAULT_CLAMP);
+
+    for(int icolor = 0; icolor < ncolors; ++icolor)
+    {
+        colormap->setRGBA(icolor, &palette_rgba[4*colors.indices[icolor]]);
+    }
+
+    colormap->setMinMax(0.0f, static_cast<float>(ncolors) - 1.0f);
+}
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// Qt
+#include <QString>
+
+// ZIB
+#include <hxcolor/HxColormap256.h>
+#include <hxspatialgraph/internal/HxSpatialGraph.h>
+
+
+namespace coda
+{
+
+
+/// The name of the integer attribute holding the packed RGBA color
+/// of each vertex or edge imported from Coda.
+extern const char* const RGBA_ATTRIBUTE;
+
+
+/**
+ * @brief The ItemColors struct
+ *
+ * The per-item colors exported by Coda, compressed with a palette. Coda
+ * usually colors millions of items with a few distinct colors, e.g. one
+ * per cluster, so each item only stores the index of its color.
+ *
+ * The colors are packed RGBA values with red in the lowest byte.
+ */
+struct ItemColors
+{
+    /// The distinct colors.
+    std::vector<std::uint32_t> palette;
+
+    /// The palette index of each item.
+    std::vector<std::uint32_t> indices;
+
+    std::int64_t numItems() const;
+    void clear();
+};
+
+
+/**
+ * Reads the binary per-item colors written by Coda from *path*.
+ *
+ * The file starts with the magic ``CODARGBA``, followed by the palette size
+ * (uint32), the size of an index in bytes (uint32, 1, 2 or 4) and the
+ * number of items (uint64). Then the palette (uint32 each) and the palette
+ * indices of the items follow. All values are little endian.
+ */
+bool readItemColors(ItemColors& colors, const QString& path);
+
+
+/**
+ * Writes the packed RGBA color of each item into the integer attribute
+ * RGBA_ATTRIBUTE of the given item *type*. The number of items must match.
+ */
+bool colorsToAttribute(
+    HxSpatialGraph* graph,
+    HxSpatialGraph::ItemType type,
+    const ItemColors& colors
+);
+
+
+/**
+ * Converts the per-item colors into a label colormap with one entry
+ * per item. The palette is converted only once.
+ */
+void colorsToColormap(HxColormap256* colormap, const ItemColors& colors);
+
+
+} // namespace coda
\ No newline at end of file
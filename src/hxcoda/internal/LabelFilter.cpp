@@ -0,0 +1,260 @@
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Local
+#include <hxcoda/internal/LabelFilter.h>
+#include <hxcoda/internal/Parallel.h>
+
+
+namespace coda
+{
+
+
+/**
+ * Creates the label-to-keep lookup table for the given selection. Labels
+ * that are kept map to a mask with all bits set, all other labels to 0,
+ * so that the kernel can filter a voxel with a single bitwise *and*.
+ */
+template<typename T>
+static std::vector<T> labelMask(
+    const std::vector<bool>& selection,
+    std::size_t nmask
+) {
+    std::vector<T> mask(nmask, T(0));
+
+    // Note the offset: The first foreground label has the value 1
+    // while the first row has index 0.
+    const std::size_t nrows = selection.size();
+    for(std::size_t label = 1; label < nmask && label <= nrows; ++label)
+    {
+        if(selection[label - 1])
+        {
+            mask[label] = static_cast<T>(~T(0));
+        }
+    }
+    return mask;
+}
+
+
+/**
+ * Kernel for types whose full value range is covered by the lookup table,
+ * i.e. ``uint8`` and ``uint16``. The loop is branch-free.
+ */
+template<typename T>
+static void filterSlabsFullRange(
+    T* result,
+    const T* input,
+    std::int64_t nvoxels,
+    const T* mask
+) {
+    for(std::int64_t i = 0; i < nvoxels; ++i)
+    {
+        const T label = input[i];
+        result[i] = label & mask[label];
+    }
+}
+
+
+/**
+ * Kernel for types with a lookup table covering only the labels
+ * ``[0, nmask)``. Negative labels wrap around to large unsigned indices,
+ * so a single comparison rejects both ends of the range.
+ */
+template<typename T>
+static void filterSlabsBounded(
+    T* result,
+    const T* input,
+    std::int64_t nvoxels,
+    const T* mask,
+    std::size_t nmask
+) {
+    typedef typename std::make_unsigned<T>::type U;
+    for(std::int64_t i = 0; i < nvoxels; ++i)
+    {
+        const T label = input[i];
+        const U index = static_cast<U>(label);
+        result[i] = index < nmask ? (label & mask[index]) : T(0);
+    }
+}
+
+
+bool isLabelKernelType(McPrimType type)
+{
+    return type == McPrimType::MC_UINT8
+        || type == McPrimType::MC_UINT16
+        || type == McPrimType::MC_INT32;
+}
+
+
+LabelFilterKernel::LabelFilterKernel(McPrimType type, const std::vector<bool>& selection)
+    : m_type(type)
+    , m_mask8()
+    , m_mask16()
+    , m_mask32()
+{
+    // The tables of the small types cover the full value range. The int32
+    // table only covers the labels which can be selected at all.
+    if(type == McPrimType::MC_UINT8)
+    {
+        m_mask8 = labelMask<std::uint8_t>(selection, 256);
+    }
+    else if(type == McPrimType::MC_UINT16)
+    {
+        m_mask16 = labelMask<std::uint16_t>(selection, 65536);
+    }
+    else if(type == McPrimType::MC_INT32)
+    {
+        const std::size_t nmask = std::min<std::size_t>(
+            selection.size() + 1,
+            static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()) + 1
+        );
+        m_mask32 = labelMask<std::int32_t>(selection, nmask);
+    }
+}
+
+
+McPrimType LabelFilterKernel::primType() const
+{
+    return m_type;
+}
+
+
+void LabelFilterKernel::apply(void* result, const void* input, std::int64_t nvoxels) const
+{
+    if(m_type == McPrimType::MC_UINT8)
+    {
+        filterSlabsFullRange<std::uint8_t>(
+            static_cast<std::uint8_t*>(result), static_cast<const std::uint8_t*>(input),
+            nvoxels, m_mask8.data()
+        );
+    }
+    else if(m_type == McPrimType::MC_UINT16)
+    {
+        filterSlabsFullRange<std::uint16_t>(
+            static_cast<std::uint16_t*>(result), static_cast<const std::uint16_t*>(input),
+            nvoxels, m_mask16.data()
+        );
+    }
+    else if(m_type == McPrimType::MC_INT32)
+    {
+        filterSlabsBounded<std::int32_t>(
+            static_cast<std::int32_t*>(result), static_cast<const std::int32_t*>(input),
+            nvoxels, m_mask32.data(), m_mask32.size()
+        );
+    }
+}
+
+
+void filterLabelKernel(
+    void* result,
+    const void* input,
+    McPrimType type,
+    std::int64_t nslice,
+    std::int64_t nslices,
+    const std::vector<bool>& selection
+) {
+    const LabelFilterKernel kernel(type, selection);
+    const std::int64_t nbytes = type.getSize();
+
+    // Each block is a slab of consecutive z-slices.
+    parallelFor(0, nslices, 1, [&](std::int64_t first, std::int64_t last) {
+        const std::int64_t offset = first*nslice*nbytes;
+        kernel.apply(
+            static_cast<char*>(result) + offset, 
+            static_cast<const char*>(input) + offset, 
+            (last - first)*nslice
+        );
+    });
+}
+
+
+/**
+ * Relabels *nvoxels* voxels with the lookup table *lut*.
+ */
+template<typename In, typename Out>
+static void relabelSlabs(
+    Out* result,
+    const In* input,
+    std::int64_t nvoxels,
+    const std::int32_t* lut,
+    std::size_t nlut
+) {
+    typedef typename std::make_unsigned<In>::type U;
+    for(std::int64_t i = 0; i < nvoxels; ++i)
+    {
+        const U index = static_cast<U>(input[i]);
+        result[i] = index < nlut ? static_cast<Out>(lut[index]) : Out(0);
+    }
+}
+
+
+template<typename In>
+static void relabelTyped(
+    void* result,
+    McPrimType result_type,
+    const In* input,
+    std::int64_t nslice,
+    std::int64_t nslices,
+    const std::vector<std::int32_t>& lut
+) {
+    parallelFor(0, nslices, 1, [&](std::int64_t first, std::int64_t last) {
+        const std::int64_t offset = first*nslice;
+        const std::int64_t nvoxels = (last - first)*nslice;
+        if(result_type == McPrimType::MC_UINT8)
+        {
+            relabelSlabs(static_cast<std::uint8_t*>(result) + offset, input + offset, nvoxels, lut.data(), lut.size());
+        }
+        else if(result_type == McPrimType::MC_UINT16)
+        {
+            relabelSlabs(static_cast<std::uint16_t*>(result) + offset, input + offset, nvoxels, lut.data(), lut.size());
+        }
+        else
+        {
+            relabelSlabs(static_cast<std::int32_t*>(result) + offset, input + offset, nvoxels, lut.data(), lut.size());
+        }
+    });
+}
+
+
+McPrimType compactLabelType(std::int64_t nlabels)
+{
+    if(nlabels <= std::numeric_limits<std::uint8_t>::max())
+    {
+        return McPrimType::MC_UINT8;
+    }
+    if(nlabels <= std::numeric_limits<std::uint16_t>::max())
+    {
+        return McPrimType::MC_UINT16;
+    }
+    return McPrimType::MC_INT32;
+}
+
+
+void relabelKernel(
+    void* result,
+    McPrimType result_type,
+    const void* input,
+    McPrimType input_type,
+    std::int64_t nslice,
+    std::int64_t nslices,
+    const std::vector<std::int32_t>& lut
+) {
+    if(input_type == McPrimType::MC_UINT8)
+    {
+        relabelTyped(result, result_type, static_cast<const std::uint8_t*>(input), nslice, nslices, lut);
+    }
+    else if(input_type == McPrimType::MC_UINT16)
+    {
+        relabelTyped(result, result_type, static_cast<const std::uint16_t*>(input), nslice, nslices, lut);
+    }
+    else if(input_type == McPrimType::MC_INT32)
+    {
+        relabelTyped(result, result_type, static_cast<const std::int32_t*>(input), nslice, nslices, lut);
+    }
+}
+
+
+} // namespace coda
\ No newline at end of file
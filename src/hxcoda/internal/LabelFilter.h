@@ -0,0 +1,98 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// ZIB
+#include <mclib/McPrimType.h>
+
+
+namespace coda
+{
+
+
+/**
+ * Returns true if the typed label filter kernels support the
+ * primitive type, i.e. ``uint8``, ``uint16`` or ``int32``.
+ */
+bool isLabelKernelType(McPrimType type);
+
+
+/**
+ * @brief The LabelFilterKernel class
+ *
+ * The label-to-keep lookup table for a selection. It can be created once and
+ * then be applied to many blocks of voxels, e.g. the bricks of a volume that
+ * does not fit into memory.
+ */
+class LabelFilterKernel
+{
+public:
+
+    LabelFilterKernel(McPrimType type, const std::vector<bool>& selection);
+
+    McPrimType primType() const;
+    
+    void apply(void* result, const void* input, std::int64_t nvoxels) const;
+
+private:
+
+    McPrimType m_type;
+
+    /// The lookup table for the primitive type *m_type*. A kept label maps
+    /// to a mask with all bits set, all other labels to 0.
+    std::vector<std::uint8_t> m_mask8;
+    std::vector<std::uint16_t> m_mask16;
+    std::vector<std::int32_t> m_mask32;
+};
+
+
+/**
+ * Filters the raw voxel data *input* of a label field into *result*.
+ *
+ * A voxel keeps its label if the label is part of the *selection* and
+ * is set to the background label 0 otherwise. As in Coda, the first
+ * foreground label 1 corresponds to the row 0 in the selection.
+ *
+ * Both buffers store *nslices* consecutive slices with *nslice* voxels
+ * each and must have the primitive type *type*. The slices are processed
+ * in parallel using a label-to-keep lookup table.
+ */
+void filterLabelKernel(
+    void* result,
+    const void* input,
+    McPrimType type,
+    std::int64_t nslice,
+    std::int64_t nslices,
+    const std::vector<bool>& selection
+);
+
+
+/**
+ * Returns the smallest primitive type supported by the label filter
+ * kernels, which can store the labels ``[0, nlabels]``.
+ */
+McPrimType compactLabelType(std::int64_t nlabels);
+
+
+/**
+ * Relabels the raw voxel data *input* of a label field into *result*, which
+ * may have a different primitive type. A voxel with the label *l* gets the
+ * new label ``lut[l]``. Labels outside of the lookup table are set to 0.
+ *
+ * Both buffers store *nslices* consecutive slices with *nslice* voxels each,
+ * which are processed in parallel.
+ */
+void relabelKernel(
+    void* result,
+    McPrimType result_type,
+    const void* input,
+    McPrimType input_type,
+    std::int64_t nslice,
+    std::int64_t nslices,
+    const std::vector<std::int32_t>& lut
+);
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,331 @@
+// STL
+#include <algorithm>
+#include <cstdint>
+
+// Local
+#include <hxcoda/internal/LabelFilter.h>
+#include <hxcoda/internal/LabelIndex.h>
+#include <hxcoda/internal/Parallel.h>
+
+
+namespace coda
+{
+
+
+/**
+ * A run found while scanning the label field, tagged with its label.
+ */
+struct LabelRun
+{
+    std::int64_t label;
+    LabelIndex::Run run;
+};
+
+
+/**
+ * Returns true if the optional cancel function *is_cancelled* is set
+ * and returns true.
+ */
+static bool isCancelled(const LabelIndex::CancelFunction& is_cancelled)
+{
+    return is_cancelled && is_cancelled();
+}
+
+
+/**
+ * Collects the runs of foreground labels in the z-slices ``[zfirst, zlast)``.
+ * Runs never cross the end of a row. The scan stops early after a slice
+ * if it is cancelled.
+ */
+template<typename T>
+static void scanRuns(
+    std::vector<LabelRun>& runs,
+    const T* data,
+    std::int64_t nx,
+    std::int64_t ny,
+    std::int64_t zfirst,
+    std::int64_t zlast,
+    const LabelIndex::CancelFunction& is_cancelled
+) {
+    for(std::int64_t iz = zfirst; iz < zlast && !isCancelled(is_cancelled); ++iz)
+    {
+        for(std::int64_t iy = 0; iy < ny; ++iy)
+        {
+            const std::int64_t row = (iz*ny + iy)*nx;
+            std::int64_t ix = 0;
+            while(ix < nx)
+            {
+                const T label = data[row + ix];
+                std::int64_t jx = ix + 1;
+                while(jx < nx && data[row + jx] == label)
+                {
+                    ++jx;
+                }
+                if(label > 0)
+                {
+                    runs.push_back(LabelRun{static_cast<std::int64_t>(label), {row + ix, jx - ix}});
+                }
+                ix = jx;
+            }
+        }
+    }
+}
+
+
+template<typename T>
+static void writeRuns(
+    void* result,
+    const LabelIndex& index,
+    const std::vector<std::int64_t>& labels,
+    const std::vector<bool>& selected,
+    const LabelIndex::CancelFunction& is_cancelled
+) {
+    T* data = static_cast<T*>(result);
+
+    parallelFor(0, static_cast<std::int64_t>(labels.size()), 1, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t i = first; i < last && !isCancelled(is_cancelled); ++i)
+        {
+            const std::int64_t label = labels[i];
+            const T value = selected[i] ? static_cast<T>(label) : T(0);
+
+            const LabelIndex::Run* runs = index.runs(label);
+            const std::int64_t nruns = index.numRuns(label);
+            for(std::int64_t irun = 0; irun < nruns; ++irun)
+            {
+                std::fill_n(data + runs[irun].offset, runs[irun].length, value);
+            }
+        }
+    });
+}
+
+
+LabelIndex::LabelIndex()
+    : m_built(false)
+    , m_type(McPrimType::MC_INT32)
+    , m_dims{0, 0, 0}
+    , m_offsets()
+    , m_runs()
+    , m_bounding_boxes()
+{}
+
+
+void LabelIndex::clear()
+{
+    m_built = false;
+    m_offsets.clear();
+    m_runs.clear();
+    m_bounding_boxes.clear();
+}
+
+
+bool LabelIndex::isEmpty() const
+{
+    return !m_built;
+}
+
+
+/**
+ * Builds the index of the label field *data*. Returns false if the type is
+ * not supported or the build has been cancelled. The cancel function is
+ * checked after every slice and, while the runs are sorted, after every
+ * slab. A cancelled index is empty.
+ */
+bool LabelIndex::build(
+    const void* data,
+    McPrimType type,
+    std::int64_t nx,
+    std::int64_t ny,
+    std::int64_t nz,
+    const CancelFunction& is_cancelled
+) {
+    clear();
+    if(!isLabelKernelType(type))
+    {
+        return false;
+    }
+
+    // Scan the z-slabs in parallel. Each slab collects its runs in scan
+    // order, so that concatenating the slabs keeps the runs of each label
+    // sorted by offset.
+    const std::int64_t nslabs = std::max<std::int64_t>(1, std::min<std::int64_t>(nz, 4*numThreads()));
+    const std::int64_t slab_size = (nz + nslabs - 1)/nslabs;
+    std::vector<std::vector<LabelRun>> slab_runs(nslabs);
+
+    parallelForChunks(nslabs, [&](std::int64_t islab) {
+        const std::int64_t zfirst = std::min(nz, islab*slab_size);
+        const std::int64_t zlast = std::min(nz, zfirst + slab_size);
+        if(type == McPrimType::MC_UINT8)
+        {
+            scanRuns(slab_runs[islab], static_cast<const std::uint8_t*>(data), nx, ny, zfirst, zlast, is_cancelled);
+        }
+        else if(type == McPrimType::MC_UINT16)
+        {
+            scanRuns(slab_runs[islab], static_cast<const std::uint16_t*>(data), nx, ny, zfirst, zlast, is_cancelled);
+        }
+        else
+        {
+            scanRuns(slab_runs[islab], static_cast<const std::int32_t*>(data), nx, ny, zfirst, zlast, is_cancelled);
+        }
+    });
+    if(isCancelled(is_cancelled))
+    {
+        return false;
+    }
+
+    // Count the runs per label.
+    std::int64_t nlabels = 1;
+    for(const auto& runs : slab_runs)
+    {
+        for(const LabelRun& run : runs)
+        {
+            nlabels = std::max(nlabels, run.label + 1);
+        }
+    }
+
+    m_offsets.assign(nlabels + 1, 0);
+    for(const auto& runs : slab_runs)
+    {
+        for(const LabelRun& run : runs)
+        {
+            ++m_offsets[run.label + 1];
+        }
+    }
+    for(std::int64_t label = 0; label < nlabels; ++label)
+    {
+        m_offsets[label + 1] += m_offsets[label];
+    }
+
+    // Scatter the runs and compute the bounding boxes.
+    const BoundingBox empty_box = {{nx, ny, nz}, {-1, -1, -1}};
+    m_runs.resize(m_offsets[nlabels]);
+    m_bounding_boxes.assign(nlabels, empty_box);
+
+    std::vector<std::int64_t> next(m_offsets.begin(), m_offsets.end() - 1);
+    for(auto& runs : slab_runs)
+    {
+        if(isCancelled(is_cancelled))
+        {
+            clear();
+            return false;
+        }
+
+        for(const LabelRun& run : runs)
+        {
+            m_runs[next[run.label]++] = run.run;
+
+            const std::int64_t ix = run.run.offset % nx;
+            const std::int64_t iy = (run.run.offset/nx) % ny;
+            const std::int64_t iz = run.run.offset/(nx*ny);
+
+            BoundingBox& box = m_bounding_boxes[run.label];
+            box.min[0] = std::min(box.min[0], ix);
+            box.min[1] = std::min(box.min[1], iy);
+            box.min[2] = std::min(box.min[2], iz);
+            box.max[0] = std::max(box.max[0], ix + run.run.length - 1);
+            box.max[1] = std::max(box.max[1], iy);
+            box.max[2] = std::max(box.max[2], iz);
+        }
+
+        // Release the memory of the slab early.
+        std::vector<LabelRun>().swap(runs);
+    }
+
+    m_type = type;
+    m_dims[0] = nx;
+    m_dims[1] = ny;
+    m_dims[2] = nz;
+    m_built = true;
+    return true;
+}
+
+
+bool LabelIndex::matches(
+    McPrimType type,
+    std::int64_t nx,
+    std::int64_t ny,
+    std::int64_t nz
+) const {
+    return m_built
+        && m_type == type
+        && m_dims[0] == nx
+        && m_dims[1] == ny
+        && m_dims[2] == nz;
+}
+
+
+std::int64_t LabelIndex::numLabels() const
+{
+    return m_built ? static_cast<std::int64_t>(m_bounding_boxes.size()) : 0;
+}
+
+
+std::int64_t LabelIndex::numRuns(std::int64_t label) const
+{
+    return m_offsets[label + 1] - m_offsets[label];
+}
+
+
+const LabelIndex::Run* LabelIndex::runs(std::int64_t label) const
+{
+    return m_runs.data() + m_offsets[label];
+}
+
+
+const LabelIndex::BoundingBox& LabelIndex::boundingBox(std::int64_t label) const
+{
+    return m_bounding_boxes[label];
+}
+
+
+/**
+ * Writes only the voxels of labels whose selection state differs between
+ * *selection* and *previous_selection* into *result*, which must contain
+ * the label field filtered with *previous_selection*.
+ *
+ * Returns the number of updated labels. The cancel function is checked
+ * after every label. A cancelled update leaves *result* partially updated.
+ */
+std::int64_t LabelIndex::apply(
+    void* result,
+    const std::vector<bool>& selection,
+    const std::vector<bool>& previous_selection,
+    const CancelFunction& is_cancelled
+) const {
+    const std::int64_t nlabels = numLabels();
+    const std::int64_t nselection = static_cast<std::int64_t>(selection.size());
+    const std::int64_t nprevious = static_cast<std::int64_t>(previous_selection.size());
+
+    // Collect the labels that changed. Note the offset: The first foreground
+    // label has the value 1 while the first row has index 0.
+    std::vector<std::int64_t> labels;
+    std::vector<bool> selected;
+    for(std::int64_t label = 1; label < nlabels; ++label)
+    {
+        const bool is_selected = label <= nselection && selection[label - 1];
+        const bool was_selected = label <= nprevious && previous_selection[label - 1];
+        if(is_selected != was_selected && numRuns(label) > 0)
+        {
+            labels.push_back(label);
+            selected.push_back(is_selected);
+        }
+    }
+
+    // The runs of different labels are disjoint, so the labels
+    // can be written in parallel.
+    if(m_type == McPrimType::MC_UINT8)
+    {
+        writeRuns<std::uint8_t>(result, *this, labels, selected, is_cancelled);
+    }
+    else if(m_type == McPrimType::MC_UINT16)
+    {
+        writeRuns<std::uint16_t>(result, *this, labels, selected, is_cancelled);
+    }
+    else
+    {
+        writeRuns<std::int32_t>(result, *this, labels, selected, is_cancelled);
+    }
+    return static_cast<std::int64_t>(labels.size());
+}
+
+
+} // namespace coda
\ No newline at end of file
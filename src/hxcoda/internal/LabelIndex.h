@@ -0,0 +1,105 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// ZIB
+#include <mclib/McPrimType.h>
+
+
+namespace coda
+{
+
+
+/**
+ * @brief The LabelIndex class
+ *
+ * A per-label index of the voxels in a label field. The voxels of each label
+ * are stored as runs of consecutive voxels along the x axis, together with the
+ * bounding box of the label.
+ *
+ * The index allows to update a filtered label field incrementally: When the
+ * selection changes, only the voxels of labels which have been added to or
+ * removed from the selection are written.
+ *
+ * Only the primitive types supported by the label filter kernels are
+ * indexed, see isLabelKernelType().
+ */
+class LabelIndex
+{
+public:
+
+    /// A run of *length* voxels starting at the linear voxel index *offset*.
+    struct Run
+    {
+        std::int64_t offset;
+        std::int64_t length;
+    };
+
+    /// The voxel bounding box of a label. The maximum is inclusive.
+    struct BoundingBox
+    {
+        std::int64_t min[3];
+        std::int64_t max[3];
+    };
+
+    /// Returns true if a running build() or apply() should stop. It is
+    /// called concurrently by the worker threads.
+    typedef std::function<bool()> CancelFunction;
+
+public:
+
+    LabelIndex();
+
+    void clear();
+    bool isEmpty() const;
+
+    bool build(
+        const void* data,
+        McPrimType type,
+        std::int64_t nx,
+        std::int64_t ny,
+        std::int64_t nz,
+        const CancelFunction& is_cancelled = CancelFunction()
+    );
+    bool matches(
+        McPrimType type,
+        std::int64_t nx,
+        std::int64_t ny,
+        std::int64_t nz
+    ) const;
+
+    std::int64_t numLabels() const;
+    std::int64_t numRuns(std::int64_t label) const;
+    const Run* runs(std::int64_t label) const;
+    const BoundingBox& boundingBox(std::int64_t label) const;
+
+    std::int64_t apply(
+        void* result,
+        const std::vector<bool>& selection,
+        const std::vector<bool>& previous_selection,
+        const CancelFunction& is_cancelled = CancelFunction()
+    ) const;
+
+private:
+
+    /// True if the index has been built.
+    bool m_built;
+
+    /// The primitive type and dimensions of the indexed label field.
+    McPrimType m_type;
+    std::int64_t m_dims[3];
+
+    /// The runs of label *i* are ``m_runs[m_offsets[i]:m_offsets[i+1]]``.
+    /// The background label 0 is not indexed.
+    std::vector<std::int64_t> m_offsets;
+    std::vector<Run> m_runs;
+
+    /// The bounding box of each label.
+    std::vector<BoundingBox> m_bounding_boxes;
+};
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,153 @@
+// STL
+#include <algorithm>
+
+// Local
+#include <hxcoda/internal/LazyLabelField.h>
+
+
+namespace coda
+{
+
+
+LazyLabelField::LazyLabelField(std::size_t max_cached_slices)
+    : m_input()
+    , m_selection()
+    , m_kernel()
+    , m_slices()
+    , m_max_cached_slices(std::max<std::size_t>(1, max_cached_slices))
+{}
+
+
+void LazyLabelField::setInput(HxUniformLabelField3* input)
+{
+    if(input != m_input.get())
+    {
+        m_input = input;
+        m_kernel.reset();
+        m_slices.clear();
+    }
+}
+
+
+HxUniformLabelField3* LazyLabelField::input() const
+{
+    return m_input.get();
+}
+
+
+void LazyLabelField::setSelection(const std::vector<bool>& selection)
+{
+    if(selection != m_selection)
+    {
+        m_selection = selection;
+        m_kernel.reset();
+        m_slices.clear();
+    }
+}
+
+
+std::int64_t LazyLabelField::numSlices() const
+{
+    return m_input ? static_cast<std::int64_t>(m_input->lattice().getDims().nz) : 0;
+}
+
+
+/**
+ * Returns the raw voxel data of the filtered slice *iz*, which has the
+ * primitive type of the input field. Returns nullptr if the slice does
+ * not exist or the input type is not supported by the label kernels.
+ *
+ * The pointer is valid until the next call.
+ */
+const void* LazyLabelField::slice(std::int64_t iz)
+{
+    if(!m_input || iz < 0 || iz >= numSlices() || !isLabelKernelType(m_input->primType()))
+    {
+        return nullptr;
+    }
+
+    // Cache hit? Move the slice to the front.
+    auto it = std::find_if(m_slices.begin(), m_slices.end(), [iz](const std::pair<std::int64_t, std::vector<char>>& slice) {
+        return slice.first == iz;
+    });
+    if(it != m_slices.end())
+    {
+        m_slices.splice(m_slices.begin(), m_slices, it);
+        return m_slices.front().second.data();
+    }
+
+    // Cache miss. Recycle the buffer of the least recently used slice.
+    std::vector<char> buffer;
+    if(m_slices.size() >= m_max_cached_slices)
+    {
+        buffer.swap(m_slices.back().second);
+        m_slices.pop_back();
+    }
+
+    const auto dims = m_input->lattice().getDims();
+    const std::int64_t nslice = static_cast<std::int64_t>(dims.nx)*static_cast<std::int64_t>(dims.ny);
+    const std::int64_t nbytes = nslice*m_input->primType().getSize();
+    const char* input = static_cast<const char*>(m_input->lattice().dataPtr()) + iz*nbytes;
+    buffer.resize(nbytes);
+
+    // An empty selection shows all labels, see filter().
+    if(m_selection.empty())
+    {
+        std::copy_n(input, nbytes, buffer.data());
+    }
+    else
+    {
+        if(!m_kernel)
+        {
+            m_kernel.reset(new LabelFilterKernel(m_input->primType(), m_selection));
+        }
+        m_kernel->apply(buffer.data(), input, nslice);
+    }
+
+    m_slices.emplace_front(iz, std::move(buffer));
+    return m_slices.front().second.data();
+}
+
+
+/**
+ * Stores the filtered slice *iz* in *result*, which becomes a label field
+ * with a single slice placed at the position of the slice in the input.
+ */
+bool LazyLabelField::sliceToField(HxUniformLabelField3* result, std::int64_t iz)
+{
+    const void* data = slice(iz);
+    if(data == nullptr)
+    {
+        return false;
+    }
+
+    const auto dims = m_input->lattice().getDims();
+    const std::int64_t nbytes = 
+        static_cast<std::int64_t>(dims.nx)*static_cast<std::int64_t>(dims.ny)*m_input->primType().getSize();
+
+    const McBox3f box = m_input->getBoundingBox();
+    const float z = dims.nz > 1
+        ? box.getMin().z + static_cast<float>(iz)*(box.getMax().z - box.getMin().z)/static_cast<float>(dims.nz - 1)
+        : box.getMin().z;
+
+    result->lattice().setPrimType(m_input->primType());
+    result->lattice().resize(McDim3l(dims.nx, dims.ny, 1));
+    result->lattice().setBoundingBox(McBox3f(
+        box.getMin().x, box.getMax().x, box.getMin().y, box.getMax().y, z, z
+    ));
+    std::copy_n(static_cast<const char*>(data), nbytes, static_cast<char*>(result->lattice().dataPtr()));
+    result->touchMinMax();
+    return true;
+}
+
+
+void LazyLabelField::clear()
+{
+    m_input.release();
+    m_selection.clear();
+    m_kernel.reset();
+    m_slices.clear();
+}
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// ZIB
+#include <mclib/McHandle.h>
+#include <hxfield/HxUniformLabelField3.h>
+
+// Local
+#include <hxcoda/internal/LabelFilter.h>
+
+
+namespace coda
+{
+
+
+/**
+ * @brief The LazyLabelField class
+ *
+ * A virtual filtered label field. It wraps the input label field and the
+ * current selection, but only filters the z-slices which are actually
+ * requested, e.g. the slice shown in a viewer.
+ *
+ * The most recently used slices are cached. Changing the selection only
+ * drops the cache, so it costs nothing until the next slice is requested.
+ */
+class LazyLabelField
+{
+public:
+
+    explicit LazyLabelField(std::size_t max_cached_slices = 8);
+
+    void setInput(HxUniformLabelField3* input);
+    HxUniformLabelField3* input() const;
+
+    void setSelection(const std::vector<bool>& selection);
+
+    std::int64_t numSlices() const;
+    const void* slice(std::int64_t iz);
+    bool sliceToField(HxUniformLabelField3* result, std::int64_t iz);
+
+    void clear();
+
+private:
+
+    /// The wrapped label field.
+    McHandle<HxUniformLabelField3> m_input;
+
+    /// The selection applied to the input.
+    std::vector<bool> m_selection;
+
+    /// The lookup table for the selection, created on the first request.
+    std::unique_ptr<LabelFilterKernel> m_kernel;
+
+    /// The filtered slices, most recently used first.
+    std::list<std::pair<std::int64_t, std::vector<char>>> m_slices;
+    std::size_t m_max_cached_slices;
+};
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,271 @@
+#pragma once
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace coda
+{
+
+
+/**
+ * Returns the number of worker threads used by the parallel kernels.
+ */
+inline int numThreads()
+{
+    const unsigned int n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+
+/**
+ * @brief The ThreadPool class
+ *
+ * The persistent worker threads of the parallel kernels. Starting a thread
+ * costs tens of microseconds, which is more than many kernels need for a
+ * small selection, so the workers are started once and then sleep until
+ * the next job.
+ *
+ * The pool runs one job at a time. The calling thread participates in the
+ * job. A job started from a worker, i.e. a nested parallel loop, runs
+ * inline on the worker. A job started while the pool is busy with a job
+ * of another thread, e.g. the GUI thread while a background filter runs,
+ * falls back to temporary threads.
+ *
+ * The pool is never destroyed, so that no worker has to be joined while
+ * the process exits.
+ */
+class ThreadPool
+{
+public:
+
+    /**
+     * Returns the pool shared by all parallel kernels.
+     */
+    static ThreadPool& instance()
+    {
+        static ThreadPool* pool = new ThreadPool(numThreads() - 1);
+        return *pool;
+    }
+
+
+    /**
+     * Calls *f(ichunk)* for all chunks in ``[0, nchunks)`` and returns when
+     * all chunks are done.
+     */
+    void run(std::int64_t nchunks, const std::function<void(std::int64_t)>& f)
+    {
+        if(isWorker() || m_workers.empty())
+        {
+            for(std::int64_t ichunk = 0; ichunk < nchunks; ++ichunk)
+            {
+                f(ichunk);
+            }
+            return;
+        }
+
+        std::unique_lock<std::mutex> run_lock(m_run_mutex, std::try_to_lock);
+        if(!run_lock.owns_lock())
+        {
+            runTemporary(nchunks, f);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &f;
+            m_nchunks = nchunks;
+            m_next = 0;
+            ++m_epoch;
+        }
+        m_wake.notify_all();
+
+        drain(f);
+
+        // Workers which wake up from now on find no job. Wait for those
+        // which are still processing their last chunk.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job = nullptr;
+        m_done.wait(lock, [this]() { return m_nactive == 0; });
+    }
+
+private:
+
+    explicit ThreadPool(int nworkers)
+        : m_job(nullptr)
+        , m_nchunks(0)
+        , m_next(0)
+        , m_epoch(0)
+        , m_nactive(0)
+    {
+        for(int iworker = 0; iworker < nworkers; ++iworker)
+        {
+            m_workers.emplace_back([this]() { work(); });
+            m_workers.back().detach();
+        }
+    }
+
+
+    static bool& isWorker()
+    {
+        static thread_local bool is_worker = false;
+        return is_worker;
+    }
+
+
+    void drain(const std::function<void(std::int64_t)>& f)
+    {
+        for(std::int64_t ichunk = m_next++; ichunk < m_nchunks; ichunk = m_next++)
+        {
+            f(ichunk);
+        }
+    }
+
+
+    void work()
+    {
+        isWorker() = true;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::uint64_t epoch = m_epoch;
+        for(;;)
+        {
+            m_wake.wait(lock, [&]() { return m_epoch != epoch; });
+            epoch = m_epoch;
+            if(!m_job)
+            {
+                continue;
+            }
+
+            const std::function<void(std::int64_t)>* job = m_job;
+            ++m_nactive;
+            lock.unlock();
+
+            drain(*job);
+
+            lock.lock();
+            if(--m_nactive == 0)
+            {
+                m_done.notify_all();
+            }
+        }
+    }
+
+
+    static void runTemporary(std::int64_t nchunks, const std::function<void(std::int64_t)>& f)
+    {
+        std::atomic<std::int64_t> next(0);
+        auto worker = [&]() {
+            for(std::int64_t ichunk = next++; ichunk < nchunks; ichunk = next++)
+            {
+                f(ichunk);
+            }
+        };
+
+        const std::int64_t nthreads = std::min<std::int64_t>(numThreads(), nchunks);
+        std::vector<std::thread> threads;
+        threads.reserve(nthreads - 1);
+        for(std::int64_t ithread = 1; ithread < nthreads; ++ithread)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+private:
+
+    std::vector<std::thread> m_workers;
+
+    /// Held by the thread whose job is running.
+    std::mutex m_run_mutex;
+
+    /// Guards the job, the epoch and the number of active workers.
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    /// The current job or nullptr if the pool is idle.
+    const std::function<void(std::int64_t)>* m_job;
+    std::int64_t m_nchunks;
+    std::atomic<std::int64_t> m_next;
+
+    /// Incremented for every job, so that a worker runs each job only once.
+    std::uint64_t m_epoch;
+
+    /// The number of workers processing chunks of the current job.
+    int m_nactive;
+};
+
+
+/**
+ * Calls *f(ichunk)* for all chunks in ``[0, nchunks)``. The chunks are
+ * distributed dynamically over the ThreadPool. A single chunk is processed
+ * directly on the calling thread.
+ */
+template<typename Function>
+void parallelForChunks(std::int64_t nchunks, Function f)
+{
+    if(nchunks <= 0)
+    {
+        return;
+    }
+    if(nchunks == 1)
+    {
+        f(std::int64_t(0));
+        return;
+    }
+
+    ThreadPool::instance().run(nchunks, [&](std::int64_t ichunk) { f(ichunk); });
+}
+
+
+/**
+ * Splits the range ``[begin, end)`` into contiguous blocks of at least
+ * *grain* items and calls *f(first, last)* for each block in parallel.
+ * Ranges smaller than two grains are processed on the calling thread.
+ */
+template<typename Function>
+void parallelFor(std::int64_t begin, std::int64_t end, std::int64_t grain, Function f)
+{
+    const std::int64_t n = end - begin;
+    if(n <= 0)
+    {
+        return;
+    }
+
+    // Use a few more blocks than threads for load balancing.
+    grain = std::max<std::int64_t>(1, grain);
+    const std::int64_t nblocks = std::max<std::int64_t>(
+        1, std::min<std::int64_t>(4*numThreads(), n/grain)
+    );
+    if(nblocks == 1)
+    {
+        f(begin, end);
+        return;
+    }
+
+    const std::int64_t block_size = (n + nblocks - 1)/nblocks;
+    parallelForChunks(nblocks, [&](std::int64_t iblock) {
+        const std::int64_t first = begin + iblock*block_size;
+        const std::int64_t last = std::min(end, first + block_size);
+        if(first < last)
+        {
+            f(first, last);
+        }
+    });
+}
+
+
+} // namespace coda
\ No newline at end of file
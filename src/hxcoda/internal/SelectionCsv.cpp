@@ -0,0 +1,243 @@
+// STL
+#include <algorithm>
+
+// Local
+#include <hxcoda/internal/Parallel.h>
+#include <hxcoda/internal/SelectionCsv.h>
+
+
+namespace coda
+{
+
+
+/**
+ * Returns true if the column *name* holds a selection mask.
+ */
+static bool isSelectionColumn(const std::string& name)
+{
+    return name == "selected" || name.compare(0, 9, "selected_") == 0;
+}
+
+
+/**
+ * Splits the *header* line into the column names and returns the separator,
+ * i.e. the first comma, semicolon or tab in the line. Quotes and spaces are
+ * removed from the names.
+ */
+static char splitHeader(std::vector<std::string>& names, std::string header)
+{
+    // Skip a UTF-8 byte order mark.
+    if(header.compare(0, 3, "\xEF\xBB\xBF") == 0)
+    {
+        header.erase(0, 3);
+    }
+
+    const std::size_t iseparator = header.find_first_of(",;\t");
+    const char separator = iseparator != std::string::npos ? header[iseparator] : ',';
+
+    names.clear();
+    std::size_t first = 0;
+    for(;;)
+    {
+        const std::size_t last = std::min(header.find(separator, first), header.size());
+
+        std::string name = header.substr(first, last - first);
+        name.erase(std::remove_if(name.begin(), name.end(), [](char c) {
+            return c == '"' || c == ' ' || c == '\r';
+        }), name.end());
+        names.push_back(name);
+
+        if(last == header.size())
+        {
+            break;
+        }
+        first = last + 1;
+    }
+    return separator;
+}
+
+
+bool readSelectionCsv(std::vector<SelectionColumn>& columns, const ReadFunction& read)
+{
+    columns.clear();
+
+    std::vector<char> buffer(1 << 20);
+    std::int64_t nbuffer = 0;
+    std::int64_t ibuffer = 0;
+    auto fill = [&]() {
+        nbuffer = read(buffer.data(), static_cast<std::int64_t>(buffer.size()));
+        ibuffer = 0;
+        return nbuffer > 0;
+    };
+
+    // The header line.
+    std::string header;
+    bool has_header = false;
+    while(!has_header && fill())
+    {
+        const char* begin = buffer.data();
+        const char* end = std::find(begin, begin + nbuffer, '\n');
+        header.append(begin, end);
+        has_header = end != begin + nbuffer;
+        ibuffer = end - begin + 1;
+    }
+    if(nbuffer < 0 || header.empty())
+    {
+        return false;
+    }
+
+    // The column of each field or -1 if the field is skipped.
+    std::vector<std::string> names;
+    const char separator = splitHeader(names, header);
+
+    std::vector<int> field_columns(names.size(), -1);
+    for(std::size_t ifield = 0; ifield < names.size(); ++ifield)
+    {
+        if(isSelectionColumn(names[ifield]))
+        {
+            field_columns[ifield] = static_cast<int>(columns.size());
+            columns.push_back(SelectionColumn{names[ifield], std::vector<bool>()});
+        }
+    }
+    if(columns.empty())
+    {
+        return true;
+    }
+
+    // The rows. Missing fields are unselected.
+    const int nfields = static_cast<int>(field_columns.size());
+    std::vector<char> row(columns.size(), false);
+    int ifield = 0;
+    bool is_selected = false;
+    bool is_fraction = false;
+    bool is_empty = true;
+
+    auto endField = [&]() {
+        if(ifield < nfields && field_columns[ifield] >= 0)
+        {
+            row[field_columns[ifield]] = is_selected;
+        }
+        ++ifield;
+        is_selected = false;
+        is_fraction = false;
+    };
+    auto endRow = [&]() {
+        endField();
+        for(std::size_t icol = 0; icol < columns.size(); ++icol)
+        {
+            columns[icol].mask.push_back(row[icol] != 0);
+            row[icol] = false;
+        }
+        ifield = 0;
+        is_empty = true;
+    };
+
+    do
+    {
+        for(; ibuffer < nbuffer; ++ibuffer)
+        {
+            const char c = buffer[ibuffer];
+            if(c == '\n')
+            {
+                if(!is_empty)
+                {
+                    endRow();
+                }
+            }
+            else if(c == separator)
+            {
+                endField();
+                is_empty = false;
+            }
+            else if('1' <= c && c <= '9')
+            {
+                is_selected = is_selected || !is_fraction;
+                is_empty = false;
+            }
+            else if(c == '.' || c == 'e' || c == 'E')
+            {
+                is_fraction = true;
+                is_empty = false;
+            }
+            else if(c != '\r' && c != ' ')
+            {
+                is_empty = false;
+            }
+        }
+    }
+    while(fill());
+
+    if(nbuffer < 0)
+    {
+        columns.clear();
+        return false;
+    }
+
+    // The last line may not be terminated.
+    if(!is_empty)
+    {
+        endRow();
+    }
+    return true;
+}
+
+
+bool writeSelectionCsv(
+    const WriteFunction& write,
+    const std::vector<std::string>& names,
+    const std::vector<const std::vector<bool>*>& masks
+) {
+    std::string header;
+    for(std::size_t icol = 0; icol < names.size(); ++icol)
+    {
+        header += (icol > 0 ? "," : "") + names[icol];
+    }
+    header += '\n';
+    if(!write(header.data(), static_cast<std::int64_t>(header.size())))
+    {
+        return false;
+    }
+
+    const std::int64_t ncolumns = static_cast<std::int64_t>(masks.size());
+    std::int64_t nrows = 0;
+    for(const std::vector<bool>* mask : masks)
+    {
+        nrows = std::max<std::int64_t>(nrows, mask->size());
+    }
+    if(ncolumns == 0)
+    {
+        return true;
+    }
+
+    // A row is a "0" or "1" per column, followed by a comma or the newline.
+    const std::int64_t row_size = 2*ncolumns;
+    const std::int64_t block_rows = std::max<std::int64_t>(1, (std::int64_t(1) << 20)/row_size);
+    std::vector<char> buffer(block_rows*row_size);
+
+    for(std::int64_t block_first = 0; block_first < nrows; block_first += block_rows)
+    {
+        const std::int64_t block_last = std::min(nrows, block_first + block_rows);
+        parallelFor(block_first, block_last, 16384, [&](std::int64_t first, std::int64_t last) {
+            for(std::int64_t irow = first; irow < last; ++irow)
+            {
+                char* fields = &buffer[(irow - block_first)*row_size];
+                for(std::int64_t icol = 0; icol < ncolumns; ++icol)
+                {
+                    const std::vector<bool>& mask = *masks[icol];
+                    const bool is_selected = irow < static_cast<std::int64_t>(mask.size()) && mask[irow];
+                    fields[2*icol] = is_selected ? '1' : '0';
+                    fields[2*icol + 1] = icol + 1 < ncolumns ? ',' : '\n';
+                }
+            }
+        });
+
+        if(!write(buffer.data(), (block_last - block_first)*row_size))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+namespace coda
+{
+
+
+/**
+ * @brief The SelectionColumn struct
+ *
+ * A selection mask read from a Coda selection file. The column "selected"
+ * holds the common selection and the columns "selected_<k>" the selections
+ * of individual tables.
+ */
+struct SelectionColumn
+{
+    std::string name;
+    std::vector<bool> mask;
+};
+
+
+/// Reads up to *size* bytes into *data* and returns the number of bytes
+/// read, 0 at the end of the file or -1 on errors.
+typedef std::function<std::int64_t(char* data, std::int64_t size)> ReadFunction;
+
+/// Writes the *size* bytes at *data*. Returns false on errors.
+typedef std::function<bool(const char* data, std::int64_t size)> WriteFunction;
+
+
+/**
+ * Reads the selection columns of a Coda selection file from *read*. Other
+ * columns are skipped. A field is selected if its integer part is not 0.
+ *
+ * Unlike a spreadsheet, the file is parsed block by block and the rows are
+ * counted in 64 bit, so the masks may have more than 2^31 rows. The masks
+ * all have the number of rows in the file.
+ */
+bool readSelectionCsv(std::vector<SelectionColumn>& columns, const ReadFunction& read);
+
+
+/**
+ * Writes the masks *masks* as the columns *names* of a selection file to
+ * *write*. The shorter masks are padded with unselected rows.
+ *
+ * Each row has the same length, so the rows of a block are formatted in
+ * parallel.
+ */
+bool writeSelectionCsv(
+    const WriteFunction& write,
+    const std::vector<std::string>& names,
+    const std::vector<const std::vector<bool>*>& masks
+);
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,352 @@
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Local
+#include <hxcoda/internal/Parallel.h>
+#include <hxcoda/internal/SpreadSheetFilter.h>
+
+
+namespace coda
+{
+
+
+/**
+ * Returns the number of trailing zero bits in the non-zero *word*.
+ */
+static int countTrailingZeros(std::uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+
+/**
+ * Packs the rows ``[first, last)`` of the *mask* into a word. Rows beyond 
+ * the end of the mask are unselected.
+ */
+static std::uint64_t packWord(
+    const std::vector<bool>& mask,
+    std::int64_t first,
+    std::int64_t last
+) {
+    last = std::min<std::int64_t>(last, mask.size());
+
+    std::uint64_t word = 0;
+    for(std::int64_t irow = first; irow < last; ++irow)
+    {
+        word |= static_cast<std::uint64_t>(mask[irow]) << (irow - first);
+    }
+    return word;
+}
+
+
+const std::vector<int>& RowIndices::table(int itable) const
+{
+    return lists[table_list[itable]];
+}
+
+
+void selectedIndices(
+    std::vector<int>& indices,
+    const std::vector<bool>& selection,
+    int nrows
+) {
+    const std::int64_t n = std::min<std::int64_t>(nrows, selection.size());
+    const std::int64_t nwords = (n + 63)/64;
+
+    // Pack the selection into words. std::vector<bool> does not expose
+    // its words, but the blocks of 64 rows are packed in parallel.
+    std::vector<std::uint64_t> words(nwords);
+    parallelFor(0, nwords, 1024, [&](std::int64_t wfirst, std::int64_t wlast) {
+        for(std::int64_t iword = wfirst; iword < wlast; ++iword)
+        {
+            words[iword] = packWord(selection, iword*64, std::min(n, iword*64 + 64));
+        }
+    });
+
+    // Emit the set bits of the non-empty words.
+    indices.clear();
+    for(std::int64_t iword = 0; iword < nwords; ++iword)
+    {
+        std::uint64_t word = words[iword];
+        while(word)
+        {
+            indices.push_back(static_cast<int>(iword*64 + countTrailingZeros(word)));
+            word &= word - 1;
+        }
+    }
+}
+
+
+void selectedRows(
+    RowIndices& rows,
+    HxSpreadSheet* input,
+    const std::vector<bool>& selection,
+    const TableSelections& table_selections
+) {
+    const int ntables = input->nTables();
+
+    // Group the tables by their selection.
+    std::vector<const std::vector<bool>*> selections;
+    std::vector<int> nrows;
+    rows.table_list.resize(ntables);
+    for(int itable = 0; itable < ntables; ++itable)
+    {
+        auto it = table_selections.constFind(itable);
+        const std::vector<bool>* table_selection = 
+            it != table_selections.constEnd() ? &it.value() : &selection;
+
+        const auto found = std::find(selections.begin(), selections.end(), table_selection);
+        const int ilist = static_cast<int>(found - selections.begin());
+        if(found == selections.end())
+        {
+            selections.push_back(table_selection);
+            nrows.push_back(0);
+        }
+        nrows[ilist] = std::max(nrows[ilist], input->nRows(itable));
+        rows.table_list[itable] = ilist;
+    }
+
+    // Convert each selection once.
+    rows.lists.resize(selections.size());
+    for(std::size_t ilist = 0; ilist < selections.size(); ++ilist)
+    {
+        selectedIndices(rows.lists[ilist], *selections[ilist], nrows[ilist]);
+    }
+}
+
+
+/**
+ * Returns true if the table *itable* of *result* has the same columns
+ * as the table in *input*.
+ */
+static bool hasLayout(HxSpreadSheet* result, HxSpreadSheet* input, int itable)
+{
+    if(itable >= result->nTables())
+    {
+        return false;
+    }
+
+    const int ncolumns = input->nColumns(itable);
+    if(result->nColumns(itable) != ncolumns)
+    {
+        return false;
+    }
+
+    for(int icol = 0; icol < ncolumns; ++icol)
+    {
+        const HxSpreadSheet::Column* a = input->column(icol, itable);
+        const HxSpreadSheet::Column* b = result->column(icol, itable);
+        if(a->type != b->type || a->name != b->name)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Gathers the rows *indices* of the numeric column *source* into *target*.
+ *
+ * The column is copied into the flat buffer *values* on the calling thread,
+ * up to the last index, which is sequential. The random access gather
+ * then runs in parallel on the buffer, and the values are written into
+ * *target* on the calling thread.
+ */
+template<typename T>
+static void gatherNumericColumn(
+    HxSpreadSheet::Column* target,
+    const HxSpreadSheet::Column* source,
+    const std::vector<int>& indices,
+    std::vector<T>& values
+) {
+    const std::int64_t nindices = static_cast<std::int64_t>(indices.size());
+    if(nindices == 0)
+    {
+        return;
+    }
+
+    // The indices are in ascending order.
+    const int nvalues = indices.back() + 1;
+    values.resize(nvalues);
+    for(int irow = 0; irow < nvalues; ++irow)
+    {
+        values[irow] = std::is_integral<T>::value 
+            ? static_cast<T>(source->intValue(irow)) 
+            : static_cast<T>(source->floatValue(irow));
+    }
+
+    std::vector<T> gathered(nindices);
+    parallelFor(0, nindices, 16384, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t i = first; i < last; ++i)
+        {
+            gathered[i] = values[indices[i]];
+        }
+    });
+
+    for(std::int64_t i = 0; i < nindices; ++i)
+    {
+        target->setValue(static_cast<int>(i), gathered[i]);
+    }
+}
+
+
+/**
+ * Copies the rows *indices* of the column *source* into *target*.
+ *
+ * The spreadsheet is not documented as thread-safe, so all values are
+ * read and written on the calling thread. Only the gather of numeric
+ * columns from a flat copy runs in parallel, see gatherNumericColumn().
+ * Integers are copied as integers, since a float only represents the
+ * integers up to 2^24 exactly.
+ */
+static void gatherColumn(
+    HxSpreadSheet::Column* target,
+    const HxSpreadSheet::Column* source,
+    const std::vector<int>& indices
+) {
+    const std::int64_t nindices = static_cast<std::int64_t>(indices.size());
+
+    switch(source->type)
+    {
+        case HxSpreadSheet::Column::STRING:
+            for(std::int64_t i = 0; i < nindices; ++i)
+            {
+                target->setValue(static_cast<int>(i), source->stringValue(indices[i]));
+            }
+            break;
+
+        case HxSpreadSheet::Column::INT:
+        {
+            std::vector<int> values;
+            gatherNumericColumn(target, source, indices, values);
+            break;
+        }
+
+        default:
+        {
+            std::vector<float> values;
+            gatherNumericColumn(target, source, indices, values);
+            break;
+        }
+    }
+}
+
+
+void gatherRows(
+    HxSpreadSheet* result,
+    HxSpreadSheet* input,
+    const RowIndices& rows
+) {
+    const int ntables = input->nTables();
+
+    // Rebuild the layout only if the input changed.
+    bool is_reusable = result->nTables() == ntables;
+    for(int itable = 0; itable < ntables && is_reusable; ++itable)
+    {
+        is_reusable = hasLayout(result, input, itable);
+    }
+
+    if(!is_reusable)
+    {
+        result->clear();
+        for(int itable = 0; itable < ntables; ++itable)
+        {
+            if(itable >= result->nTables())
+            {
+                result->addTable(input->tableName(itable));
+            }
+
+            const int ncolumns = input->nColumns(itable);
+            for(int icol = 0; icol < ncolumns; ++icol)
+            {
+                const HxSpreadSheet::Column* column = input->column(icol, itable);
+                result->addColumn(column->name.getString(), column->type, itable);
+            }
+        }
+    }
+
+    for(int itable = 0; itable < ntables; ++itable)
+    {
+        // Rows beyond the end of a table are skipped.
+        const std::vector<int>& indices = rows.table(itable);
+        const int nrows = input->nRows(itable);
+        const auto end = std::lower_bound(indices.begin(), indices.end(), nrows);
+        const std::vector<int> table_indices(indices.begin(), end);
+
+        result->setNumRows(static_cast<int>(table_indices.size()), itable);
+
+        // The columns are written one after another, see gatherColumn().
+        const int ncolumns = input->nColumns(itable);
+        for(int icol = 0; icol < ncolumns; ++icol)
+        {
+            gatherColumn(result->column(icol, itable), input->column(icol, itable), table_indices);
+        }
+    }
+}
+
+
+void updateSelectionColumn(
+    HxSpreadSheet::Column* column,
+    const std::vector<bool>& selection,
+    const std::vector<bool>& previous
+) {
+    const std::int64_t n = static_cast<std::int64_t>(selection.size());
+    const std::int64_t nwords = (n + 63)/64;
+    const std::int64_t nprevious = static_cast<std::int64_t>(previous.size());
+
+    // Compare the masks in parallel.
+    std::vector<std::uint64_t> words(nwords);
+    std::vector<std::uint64_t> changes(nwords);
+    parallelFor(0, nwords, 1024, [&](std::int64_t wfirst, std::int64_t wlast) {
+        for(std::int64_t iword = wfirst; iword < wlast; ++iword)
+        {
+            const std::int64_t first = iword*64;
+            const std::int64_t last = std::min(n, first + 64);
+            const std::uint64_t word = packWord(selection, first, last);
+
+            // Rows beyond the end of the previous mask have not been 
+            // written yet.
+            std::uint64_t changed = ~std::uint64_t(0);
+            if(last <= nprevious)
+            {
+                changed = word ^ packWord(previous, first, last);
+            }
+            if(last - first < 64)
+            {
+                changed &= (std::uint64_t(1) << (last - first)) - 1;
+            }
+
+            words[iword] = word;
+            changes[iword] = changed;
+        }
+    });
+
+    // Write the changed rows on the calling thread, see gatherColumn().
+    for(std::int64_t iword = 0; iword < nwords; ++iword)
+    {
+        std::uint64_t changed = changes[iword];
+        while(changed)
+        {
+            const int ibit = countTrailingZeros(changed);
+            const int value = static_cast<int>((words[iword] >> ibit) & 1);
+            column->setValue(static_cast<int>(iword*64 + ibit), value);
+            changed &= changed - 1;
+        }
+    }
+}
+
+
+} // namespace coda
\ No newline at end of file
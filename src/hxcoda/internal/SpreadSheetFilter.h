@@ -0,0 +1,101 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// Qt
+#include <QMap>
+
+// ZIB
+#include <hxspreadsheet/internal/HxSpreadSheet.h>
+
+
+namespace coda
+{
+
+
+/// Maps the index of a table in a spreadsheet to the selection Coda
+/// made on this table. Tables without an entry use the common selection.
+typedef QMap<int, std::vector<bool>> TableSelections;
+
+
+/**
+ * @brief The RowIndices struct
+ *
+ * The indices of the selected rows of each table in a spreadsheet. The
+ * tables with the same selection share one index list. The lists are
+ * reused when the selection changes.
+ */
+struct RowIndices
+{
+    /// The distinct index lists in ascending order.
+    std::vector<std::vector<int>> lists;
+
+    /// The index list of each table.
+    std::vector<int> table_list;
+
+    const std::vector<int>& table(int itable) const;
+};
+
+
+/**
+ * Returns the indices of the selected rows in ``[0, nrows)``. Rows beyond
+ * the size of the *selection* are not selected.
+ *
+ * The selection is scanned 64 rows at a time, so runs of unselected rows
+ * are skipped at once.
+ */
+void selectedIndices(
+    std::vector<int>& indices,
+    const std::vector<bool>& selection,
+    int nrows
+);
+
+
+/**
+ * Computes the indices of the selected rows of all tables in *input*. A
+ * table uses its entry in *table_selections* or the common *selection*.
+ * Each distinct selection is converted only once.
+ *
+ * The index list of a table may contain rows beyond the end of the table
+ * if it is shared with a longer table.
+ */
+void selectedRows(
+    RowIndices& rows,
+    HxSpreadSheet* input,
+    const std::vector<bool>& selection,
+    const TableSelections& table_selections
+);
+
+
+/**
+ * Gathers the selected *rows* of all tables of *input* into the compact
+ * spreadsheet *result*.
+ *
+ * The rows are gathered in parallel from flat copies of the columns, which
+ * are read on the calling thread. If *result* already has the layout of
+ * the input, e.g. from the previous selection, its columns are reused and
+ * only the number of rows changes.
+ */
+void gatherRows(
+    HxSpreadSheet* result,
+    HxSpreadSheet* input,
+    const RowIndices& rows
+);
+
+
+/**
+ * Writes the selection mask *selection* into the integer *column*, which
+ * holds the mask *previous* from the last call. Only the rows whose value
+ * changed are written, the unchanged runs are skipped 64 rows at a time.
+ *
+ * Pass an empty *previous* mask to write all rows.
+ */
+void updateSelectionColumn(
+    HxSpreadSheet::Column* column,
+    const std::vector<bool>& selection,
+    const std::vector<bool>& previous
+);
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,301 @@
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Local
+#include <hxcoda/internal/Subgraph.h>
+
+
+namespace coda
+{
+
+
+const char* const ORIGINAL_INDEX_ATTRIBUTE = "coda_original_index";
+
+
+/**
+ * Returns the attribute of *result* matching the attribute *source* of
+ * the input graph. The attribute is only created if it does not exist yet,
+ * so that the attribute layout of the result is reused.
+ */
+static GraphAttribute* matchingAttribute(
+    HxSpatialGraph* result,
+    GraphAttribute* source,
+    HxSpatialGraph::ItemType type
+) {
+    GraphAttribute* attribute = result->findAttribute(type, source->getName());
+    if(
+        attribute
+        && attribute->primType() == source->primType()
+        && attribute->nDataVar() == source->nDataVar()
+    ) {
+        return attribute;
+    }
+    if(attribute)
+    {
+        result->deleteAttribute(attribute);
+    }
+    return result->addAttribute(source->getName(), type, source->primType(), source->nDataVar());
+}
+
+
+/**
+ * Deletes the attributes of the given *type* from *result*, which the
+ * input graph does not have (anymore). They would otherwise keep the
+ * stale values of a previous call, since clear() does not remove the
+ * attributes. The original indices are kept, they are rewritten anyway.
+ */
+static void deleteStaleAttributes(
+    HxSpatialGraph* result,
+    HxSpatialGraph* input,
+    HxSpatialGraph::ItemType type
+) {
+    // Iterate backwards, since deleting an attribute shifts the indices
+    // of the following ones.
+    for(int iattribute = result->numAttributes(type) - 1; iattribute >= 0; --iattribute)
+    {
+        GraphAttribute* attribute = result->attribute(type, iattribute);
+        const char* name = attribute->getName();
+        if(std::strcmp(name, ORIGINAL_INDEX_ATTRIBUTE) != 0 && !input->findAttribute(type, name))
+        {
+            result->deleteAttribute(attribute);
+        }
+    }
+}
+
+
+/**
+ * Stores the original index ``items[i]`` of each item *i* in the
+ * attribute ORIGINAL_INDEX_ATTRIBUTE of the given *type*.
+ */
+static void writeOriginalIndices(
+    HxSpatialGraph* result,
+    HxSpatialGraph::ItemType type,
+    const std::vector<int>& items
+) {
+    auto attribute = dynamic_cast<EdgeVertexAttribute*>(result->findAttribute(type, ORIGINAL_INDEX_ATTRIBUTE));
+    if(attribute && (attribute->primType() != McPrimType::MC_INT32 || attribute->nDataVar() != 1))
+    {
+        result->deleteAttribute(attribute);
+        attribute = nullptr;
+    }
+    if(!attribute)
+    {
+        attribute = dynamic_cast<EdgeVertexAttribute*>(
+            result->addAttribute(ORIGINAL_INDEX_ATTRIBUTE, type, McPrimType::MC_INT32, 1)
+        );
+    }
+
+    const std::int64_t nitems = static_cast<std::int64_t>(items.size());
+    for(std::int64_t inew = 0; inew < nitems; ++inew)
+    {
+        attribute->setIntDataAtIdx(static_cast<int>(inew), items[inew]);
+    }
+}
+
+
+/**
+ * Copies the values of the vertex or edge attribute *source* for the
+ * items *items* into the attribute *target*. The new index of the item
+ * ``items[i]`` is *i*.
+ */
+static void copyItemAttribute(
+    EdgeVertexAttribute* target,
+    EdgeVertexAttribute* source,
+    const std::vector<int>& items
+) {
+    const int ndatavar = source->nDataVar();
+    const std::int64_t nitems = static_cast<std::int64_t>(items.size());
+
+    if(source->primType() == McPrimType::MC_INT32)
+    {
+        for(std::int64_t inew = 0; inew < nitems; ++inew)
+        {
+            std::copy_n(source->intDataAtIdx(items[inew]), ndatavar, target->intDataAtIdx(static_cast<int>(inew)));
+        }
+    }
+    else
+    {
+        for(std::int64_t inew = 0; inew < nitems; ++inew)
+        {
+            std::copy_n(source->floatDataAtIdx(items[inew]), ndatavar, target->floatDataAtIdx(static_cast<int>(inew)));
+        }
+    }
+}
+
+
+/**
+ * Copies the values of the point attribute *source* for the points
+ * of the edges *edges* into the attribute *target*.
+ */
+static void copyPointAttribute(
+    PointAttribute* target,
+    PointAttribute* source,
+    HxSpatialGraph* input,
+    const std::vector<int>& edges
+) {
+    const int ndatavar = source->nDataVar();
+    const std::int64_t nedges = static_cast<std::int64_t>(edges.size());
+
+    for(std::int64_t inew = 0; inew < nedges; ++inew)
+    {
+        const int iold = edges[inew];
+        const int npoints = input->getNumEdgePoints(iold);
+        for(int ipoint = 0; ipoint < npoints; ++ipoint)
+        {
+            if(source->primType() == McPrimType::MC_INT32)
+            {
+                std::copy_n(source->intDataAtPoint(iold, ipoint), ndatavar, target->intDataAtPoint(inew, ipoint));
+            }
+            else
+            {
+                std::copy_n(source->floatDataAtPoint(iold, ipoint), ndatavar, target->floatDataAtPoint(inew, ipoint));
+            }
+        }
+    }
+}
+
+
+void copySubgraph(
+    HxSpatialGraph* result,
+    HxSpatialGraph* input,
+    const GraphAdjacency& adjacency,
+    const std::vector<bool>& vertices,
+    const std::vector<bool>& edges
+) {
+    const std::vector<int>& sources = adjacency.sources();
+    const std::vector<int>& targets = adjacency.targets();
+    const std::int64_t nvertices = std::min<std::int64_t>(adjacency.numVertices(), vertices.size());
+    const std::int64_t nedges = std::min<std::int64_t>(adjacency.numEdges(), edges.size());
+
+    // Renumber the vertices. The spatialgraph API indexes the items with
+    // int, so the new and old indices are stored as int.
+    std::vector<int> vertex_map(adjacency.numVertices(), -1);
+    std::vector<int> kept_vertices;
+    for(std::int64_t ivertex = 0; ivertex < nvertices; ++ivertex)
+    {
+        if(vertices[ivertex])
+        {
+            vertex_map[ivertex] = static_cast<int>(kept_vertices.size());
+            kept_vertices.push_back(static_cast<int>(ivertex));
+        }
+    }
+
+    // Keep only edges whose endpoints are both kept.
+    std::vector<int> kept_edges;
+    for(std::int64_t iedge = 0; iedge < nedges; ++iedge)
+    {
+        if(
+            edges[iedge]
+            && sources[iedge] >= 0 && vertex_map[sources[iedge]] >= 0
+            && targets[iedge] >= 0 && vertex_map[targets[iedge]] >= 0
+        ) {
+            kept_edges.push_back(static_cast<int>(iedge));
+        }
+    }
+
+    // Rebuild the topology inside of the existing result object.
+    result->clear();
+    result->parameters = input->parameters;
+
+    for(const int ivertex : kept_vertices)
+    {
+        result->addVertex(input->getVertexCoords(ivertex));
+    }
+    for(const int iedge : kept_edges)
+    {
+        result->addEdge(
+            vertex_map[sources[iedge]],
+            vertex_map[targets[iedge]],
+            input->getEdgePoints(iedge)
+        );
+    }
+
+    // Copy the attributes.
+    deleteStaleAttributes(result, input, HxSpatialGraph::VERTEX);
+    deleteStaleAttributes(result, input, HxSpatialGraph::EDGE);
+    deleteStaleAttributes(result, input, HxSpatialGraph::POINT);
+
+    const int nvertex_attributes = input->numAttributes(HxSpatialGraph::VERTEX);
+    for(int iattribute = 0; iattribute < nvertex_attributes; ++iattribute)
+    {
+        GraphAttribute* source = input->attribute(HxSpatialGraph::VERTEX, iattribute);
+        GraphAttribute* target = matchingAttribute(result, source, HxSpatialGraph::VERTEX);
+        copyItemAttribute(
+            dynamic_cast<EdgeVertexAttribute*>(target),
+            dynamic_cast<EdgeVertexAttribute*>(source),
+            kept_vertices
+        );
+    }
+
+    const int nedge_attributes = input->numAttributes(HxSpatialGraph::EDGE);
+    for(int iattribute = 0; iattribute < nedge_attributes; ++iattribute)
+    {
+        GraphAttribute* source = input->attribute(HxSpatialGraph::EDGE, iattribute);
+        GraphAttribute* target = matchingAttribute(result, source, HxSpatialGraph::EDGE);
+        copyItemAttribute(
+            dynamic_cast<EdgeVertexAttribute*>(target),
+            dynamic_cast<EdgeVertexAttribute*>(source),
+            kept_edges
+        );
+    }
+
+    const int npoint_attributes = input->numAttributes(HxSpatialGraph::POINT);
+    for(int iattribute = 0; iattribute < npoint_attributes; ++iattribute)
+    {
+        GraphAttribute* source = input->attribute(HxSpatialGraph::POINT, iattribute);
+        GraphAttribute* target = matchingAttribute(result, source, HxSpatialGraph::POINT);
+        copyPointAttribute(
+            dynamic_cast<PointAttribute*>(target),
+            dynamic_cast<PointAttribute*>(source),
+            input,
+            kept_edges
+        );
+    }
+
+    // Remember where the items came from. This overwrites the original
+    // indices copied from the input, if it is filtered itself.
+    writeOriginalIndices(result, HxSpatialGraph::VERTEX, kept_vertices);
+    writeOriginalIndices(result, HxSpatialGraph::EDGE, kept_edges);
+}
+
+
+bool mapToParent(
+    std::vector<bool>& parent_selection,
+    HxSpatialGraph* child,
+    HxSpatialGraph::ItemType type,
+    const std::vector<bool>& selection,
+    std::int64_t nparent
+) {
+    auto attribute = dynamic_cast<EdgeVertexAttribute*>(child->findAttribute(type, ORIGINAL_INDEX_ATTRIBUTE));
+    if(!attribute || attribute->primType() != McPrimType::MC_INT32)
+    {
+        return false;
+    }
+
+    // The masks are dense, so this is linear in the number of parent and
+    // child items. Only the original indices of the selected items are read.
+    parent_selection.assign(nparent, false);
+
+    // A selection longer than the child is clipped to its items.
+    const std::int64_t nchild = type == HxSpatialGraph::VERTEX ? child->getNumVertices() : child->getNumEdges();
+    const std::int64_t nitems = std::min<std::int64_t>(nchild, selection.size());
+    for(std::int64_t iitem = 0; iitem < nitems; ++iitem)
+    {
+        if(!selection[iitem])
+        {
+            continue;
+        }
+
+        const int iparent = *attribute->intDataAtIdx(static_cast<int>(iitem));
+        if(0 <= iparent && iparent < nparent)
+        {
+            parent_selection[iparent] = true;
+        }
+    }
+    return true;
+}
+
+
+} // namespace coda
\ No newline at end of file
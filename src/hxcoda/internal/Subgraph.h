@@ -0,0 +1,68 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <vector>
+
+// ZIB
+#include <hxspatialgraph/internal/HxSpatialGraph.h>
+
+// Local
+#include <hxcoda/internal/GraphAdjacency.h>
+
+
+namespace coda
+{
+
+
+/// The name of the integer vertex and edge attributes of a filtered 
+/// spatialgraph storing the index of each item in the input graph.
+extern const char* const ORIGINAL_INDEX_ATTRIBUTE;
+
+
+/**
+ * Writes the subgraph of *input* consisting of the vertices and edges
+ * marked in *vertices* and *edges* directly into *result*.
+ *
+ * Unlike ``input->getSubgraph()`` followed by ``result->copyFrom()``, no
+ * temporary graph is created: The vertices, edges, points and attributes
+ * are copied exactly once. The result object and its attribute layout are
+ * reused between calls.
+ *
+ * An edge is only copied if both of its endpoints are marked. The vertices
+ * and edges are renumbered consecutively, keeping their relative order.
+ * The endpoints are taken from the *adjacency* index of the input.
+ *
+ * The index of each vertex and edge in the input is stored in the
+ * attribute ORIGINAL_INDEX_ATTRIBUTE of the result.
+ */
+void copySubgraph(
+    HxSpatialGraph* result,
+    HxSpatialGraph* input,
+    const GraphAdjacency& adjacency,
+    const std::vector<bool>& vertices,
+    const std::vector<bool>& edges
+);
+
+
+
+/**
+ * Maps the selection mask *selection* of the vertices or edges of a filtered
+ * spatialgraph *child* to the graph it has been filtered from. The parent has
+ * *nparent* items of the given *type*.
+ *
+ * Both selections are dense masks, so the cost is linear in the number of
+ * parent and child items, not in the number of selected items.
+ *
+ * Returns false if the child has no original indices, see copySubgraph().
+ */
+bool mapToParent(
+    std::vector<bool>& parent_selection,
+    HxSpatialGraph* child,
+    HxSpatialGraph::ItemType type,
+    const std::vector<bool>& selection,
+    std::int64_t nparent
+);
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,178 @@
+// STL
+#include <algorithm>
+
+// Local
+#include <hxcoda/internal/SubgraphCache.h>
+
+
+namespace coda
+{
+
+
+/**
+ * FNV-1a hash of the selection mask, including its size.
+ */
+static std::uint64_t hashSelection(const std::vector<bool>& selection)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::uint64_t word) {
+        hash ^= word;
+        hash *= 1099511628211ull;
+    };
+
+    mix(selection.size());
+
+    std::uint64_t word = 0;
+    const std::size_t n = selection.size();
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        word |= static_cast<std::uint64_t>(selection[i]) << (i % 64);
+        if(i % 64 == 63)
+        {
+            mix(word);
+            word = 0;
+        }
+    }
+    mix(word);
+    return hash;
+}
+
+
+/**
+ * Estimates the memory used by the spatialgraph *graph*.
+ */
+static std::int64_t estimateBytes(HxSpatialGraph* graph)
+{
+    const std::int64_t nvertices = graph->getNumVertices();
+    const std::int64_t nedges = graph->getNumEdges();
+    const std::int64_t npoints = graph->getTotalNumPoints();
+
+    // The coordinates and the topology.
+    std::int64_t nbytes = nvertices*3*sizeof(float) + nedges*2*sizeof(int) + npoints*3*sizeof(float);
+
+    // The attributes.
+    const HxSpatialGraph::ItemType types[3] = {
+        HxSpatialGraph::VERTEX, HxSpatialGraph::EDGE, HxSpatialGraph::POINT
+    };
+    const std::int64_t nitems[3] = {nvertices, nedges, npoints};
+    for(int itype = 0; itype < 3; ++itype)
+    {
+        const int nattributes = graph->numAttributes(types[itype]);
+        for(int iattribute = 0; iattribute < nattributes; ++iattribute)
+        {
+            const GraphAttribute* attribute = graph->attribute(types[itype], iattribute);
+            nbytes += nitems[itype]*attribute->nDataVar()*4;
+        }
+    }
+    return nbytes;
+}
+
+
+SubgraphCache::SubgraphCache(std::int64_t max_bytes)
+    : m_entries()
+    , m_max_bytes(max_bytes)
+    , m_nbytes(0)
+{}
+
+
+void SubgraphCache::setMaxBytes(std::int64_t max_bytes)
+{
+    m_max_bytes = max_bytes;
+    evict();
+}
+
+
+std::int64_t SubgraphCache::maxBytes() const
+{
+    return m_max_bytes;
+}
+
+
+std::int64_t SubgraphCache::numBytes() const
+{
+    return m_nbytes;
+}
+
+
+void SubgraphCache::clear()
+{
+    m_entries.clear();
+    m_nbytes = 0;
+}
+
+
+/**
+ * Returns the cached result of filtering *input* with the modification
+ * *stamp* with the *selection*, or nullptr if it is not cached. The entry
+ * becomes the most recently used one.
+ */
+HxSpatialGraph* SubgraphCache::find(
+    HxSpatialGraph* input,
+    std::uint64_t stamp,
+    const std::vector<bool>& selection
+) {
+    const std::uint64_t hash = hashSelection(selection);
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& entry) {
+        return entry.input == input 
+            && entry.stamp == stamp 
+            && entry.hash == hash 
+            && entry.selection == selection;
+    });
+    if(it == m_entries.end())
+    {
+        return nullptr;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    return m_entries.front().filtered.get();
+}
+
+
+/**
+ * Stores *filtered*, the result of filtering *input* with the modification
+ * *stamp* with the *selection*. The graph itself is kept, not a copy. Results
+ * larger than the budget are not cached.
+ */
+void SubgraphCache::insert(
+    HxSpatialGraph* input,
+    std::uint64_t stamp,
+    const std::vector<bool>& selection,
+    HxSpatialGraph* filtered
+) {
+    const std::int64_t nbytes = estimateBytes(filtered);
+    if(nbytes > m_max_bytes || contains(filtered) || find(input, stamp, selection))
+    {
+        return;
+    }
+
+    m_entries.push_front(Entry{
+        McHandle<HxSpatialGraph>(input), stamp, hashSelection(selection), 
+        selection, McHandle<HxSpatialGraph>(filtered), nbytes
+    });
+    m_nbytes += nbytes;
+    evict();
+}
+
+
+/**
+ * Returns true if the graph *filtered* is one of the cached graphs.
+ */
+bool SubgraphCache::contains(const HxSpatialGraph* filtered) const
+{
+    return std::any_of(m_entries.begin(), m_entries.end(), [&](const Entry& entry) {
+        return entry.filtered.get() == filtered;
+    });
+}
+
+
+void SubgraphCache::evict()
+{
+    while(!m_entries.empty() && m_nbytes > m_max_bytes)
+    {
+        m_nbytes -= m_entries.back().nbytes;
+        m_entries.pop_back();
+    }
+}
+
+
+} // namespace coda
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <list>
+#include <vector>
+
+// ZIB
+#include <mclib/McHandle.h>
+#include <hxspatialgraph/internal/HxSpatialGraph.h>
+
+
+namespace coda
+{
+
+
+/**
+ * @brief The SubgraphCache class
+ *
+ * A least recently used cache of filtered spatialgraphs. The entries are
+ * keyed by the input graph, its modification stamp, see Coda::graphStamp(),
+ * and the content of the selection, so toggling between a few selections
+ * does not filter the graph again. Entries of an outdated stamp are never
+ * found and eventually evicted.
+ *
+ * The cache does not copy the graphs: A cached graph is shown as result
+ * directly, so a new selection must not be filtered into a graph which
+ * the cache contains(). The least recently used entries are evicted once
+ * the memory budget is exceeded.
+ */
+class SubgraphCache
+{
+public:
+
+    explicit SubgraphCache(std::int64_t max_bytes = 256*1024*1024);
+
+    void setMaxBytes(std::int64_t max_bytes);
+    std::int64_t maxBytes() const;
+    std::int64_t numBytes() const;
+
+    void clear();
+
+    HxSpatialGraph* find(
+        HxSpatialGraph* input,
+        std::uint64_t stamp,
+        const std::vector<bool>& selection
+    );
+    void insert(
+        HxSpatialGraph* input,
+        std::uint64_t stamp,
+        const std::vector<bool>& selection,
+        HxSpatialGraph* filtered
+    );
+    bool contains(const HxSpatialGraph* filtered) const;
+
+private:
+
+    /// A cached filter result.
+    struct Entry
+    {
+        McHandle<HxSpatialGraph> input;
+        std::uint64_t stamp;
+        std::uint64_t hash;
+        std::vector<bool> selection;
+        McHandle<HxSpatialGraph> filtered;
+        std::int64_t nbytes;
+    };
+
+    void evict();
+
+private:
+
+    /// The entries, the most recently used first.
+    std::list<Entry> m_entries;
+
+    /// The memory budget and the estimated memory used by the entries.
+    std::int64_t m_max_bytes;
+    std::int64_t m_nbytes;
+};
+
+
+} // namespace coda
\ No newline at end of file
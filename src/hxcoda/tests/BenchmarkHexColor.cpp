@@ -0,0 +1,73 @@
+// STL
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Local
+#include <hxcoda/internal/HexColor.h>
+#include <hxcoda/internal/Parallel.h>
+#include <hxcoda/tests/TestUtils.h>
+
+
+using namespace coda;
+
+
+/**
+ * Measures the throughput of the hex color codec for a per-item coloring,
+ * one color at a time and for whole columns.
+ *
+ * Usage: hxcoda_benchmark_hex_color [ncolors]
+ */
+int main(int argc, char** argv)
+{
+    std::int64_t ncolors = 1000000;
+    if(argc == 2)
+    {
+        ncolors = std::atoll(argv[1]);
+    }
+
+    std::mt19937 random(42);
+    std::vector<float> rgba(4*ncolors);
+    for(auto& value : rgba)
+    {
+        value = static_cast<float>(random() % 256)/255.0f;
+    }
+
+    std::vector<char> serial_hex(HEX_RGBA_SIZE*ncolors);
+    std::vector<char> column_hex(HEX_RGBA_SIZE*ncolors);
+    std::vector<float> serial_rgba(4*ncolors);
+    std::vector<float> column_rgba(4*ncolors);
+
+    const double encode_ms = test::bestTime(5, [&]() {
+        for(std::int64_t icolor = 0; icolor < ncolors; ++icolor)
+        {
+            rgbaToHex(&serial_hex[HEX_RGBA_SIZE*icolor], &rgba[4*icolor]);
+        }
+    });
+    const double encode_column_ms = test::bestTime(5, [&]() {
+        rgbaToHexColumn(column_hex.data(), rgba.data(), ncolors);
+    });
+    CODA_CHECK(serial_hex == column_hex);
+
+    const double decode_ms = test::bestTime(5, [&]() {
+        for(std::int64_t icolor = 0; icolor < ncolors; ++icolor)
+        {
+            rgbaFromHex(&serial_rgba[4*icolor], &serial_hex[HEX_RGBA_SIZE*icolor]);
+        }
+    });
+    const double decode_column_ms = test::bestTime(5, [&]() {
+        rgbaFromHexColumn(column_rgba.data(), column_hex.data(), ncolors);
+    });
+    CODA_CHECK(serial_rgba == rgba);
+    CODA_CHECK(column_rgba == rgba);
+
+    const double mcolors = static_cast<double>(ncolors)/1.0e6;
+    std::printf("hex color codec, %lld colors, %d threads\n", static_cast<long long>(ncolors), numThreads());
+    std::printf("  encode:        %8.2f ms  %8.1f Mcolor/s\n", encode_ms, 1000.0*mcolors/encode_ms);
+    std::printf("  encode column: %8.2f ms  %8.1f Mcolor/s\n", encode_column_ms, 1000.0*mcolors/encode_column_ms);
+    std::printf("  decode:        %8.2f ms  %8.1f Mcolor/s\n", decode_ms, 1000.0*mcolors/decode_ms);
+    std::printf("  decode column: %8.2f ms  %8.1f Mcolor/s\n", decode_column_ms, 1000.0*mcolors/decode_column_ms);
+    return 0;
+}
\ No newline at end of file
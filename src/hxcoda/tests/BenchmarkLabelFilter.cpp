@@ -0,0 +1,88 @@
+// STL
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Local
+#include <hxcoda/internal/LabelFilter.h>
+#include <hxcoda/internal/Parallel.h>
+#include <hxcoda/tests/TestUtils.h>
+
+
+using namespace coda;
+
+
+/**
+ * Compares the throughput of the parallel label filter with a single
+ * thread and measures the cost of a parallel loop over a small range.
+ *
+ * Usage: hxcoda_benchmark_label_filter [nx ny nz]
+ */
+int main(int argc, char** argv)
+{
+    std::int64_t nx = 256;
+    std::int64_t ny = 256;
+    std::int64_t nz = 256;
+    if(argc == 4)
+    {
+        nx = std::atoll(argv[1]);
+        ny = std::atoll(argv[2]);
+        nz = std::atoll(argv[3]);
+    }
+
+    const std::int64_t nslice = nx*ny;
+    const std::int64_t nvoxels = nslice*nz;
+    const int nlabels = 10000;
+
+    // A random uint16 label field and a random selection of half the labels.
+    std::mt19937 random(42);
+    std::vector<std::uint16_t> input(nvoxels);
+    for(auto& label : input)
+    {
+        label = static_cast<std::uint16_t>(random() % (nlabels + 1));
+    }
+
+    std::vector<bool> selection(nlabels);
+    for(int irow = 0; irow < nlabels; ++irow)
+    {
+        selection[irow] = random() % 2 == 0;
+    }
+
+    std::vector<std::uint16_t> serial(nvoxels);
+    std::vector<std::uint16_t> parallel(nvoxels);
+
+    const double serial_ms = test::bestTime(5, [&]() {
+        const LabelFilterKernel kernel(McPrimType::MC_UINT16, selection);
+        kernel.apply(serial.data(), input.data(), nvoxels);
+    });
+    const double parallel_ms = test::bestTime(5, [&]() {
+        filterLabelKernel(parallel.data(), input.data(), McPrimType::MC_UINT16, nslice, nz, selection);
+    });
+    CODA_CHECK(serial == parallel);
+
+    const double mvoxels = static_cast<double>(nvoxels)/1.0e6;
+    std::printf("label filter %lldx%lldx%lld uint16, %d threads\n",
+        static_cast<long long>(nx), static_cast<long long>(ny), static_cast<long long>(nz), numThreads());
+    std::printf("  serial:   %8.2f ms  %8.1f Mvoxel/s\n", serial_ms, 1000.0*mvoxels/serial_ms);
+    std::printf("  parallel: %8.2f ms  %8.1f Mvoxel/s\n", parallel_ms, 1000.0*mvoxels/parallel_ms);
+    std::printf("  speedup:  %8.2f\n", serial_ms/parallel_ms);
+
+    // The dispatch cost of a loop which is just large enough to be split.
+    const int nloops = 10000;
+    std::vector<int> small(2*1024);
+    const double small_ms = test::bestTime(3, [&]() {
+        for(int iloop = 0; iloop < nloops; ++iloop)
+        {
+            parallelFor(0, small.size(), 1024, [&](std::int64_t first, std::int64_t last) {
+                for(std::int64_t i = first; i < last; ++i)
+                {
+                    ++small[i];
+                }
+            });
+        }
+    });
+    std::printf("small parallel loop: %8.2f us per call\n", 1000.0*small_ms/nloops);
+    return 0;
+}
\ No newline at end of file
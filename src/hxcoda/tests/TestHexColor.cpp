@@ -0,0 +1,100 @@
+// STL
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Local
+#include <hxcoda/internal/HexColor.h>
+#include <hxcoda/tests/TestUtils.h>
+
+
+using namespace coda;
+
+
+/**
+ * Every value of every channel is zero padded, decoded exactly and
+ * encoded again to the same digits.
+ */
+static void testRoundTrip()
+{
+    for(int ichannel = 0; ichannel < 4; ++ichannel)
+    {
+        for(int value = 0; value < 256; ++value)
+        {
+            float rgba[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            rgba[ichannel] = static_cast<float>(value)/255.0f;
+
+            char hex[HEX_RGBA_SIZE];
+            rgbaToHex(hex, rgba);
+
+            int values[4] = {0, 0, 0, 0};
+            values[ichannel] = value;
+
+            char expected[HEX_RGBA_SIZE];
+            std::snprintf(expected, sizeof(expected), "#%02x%02x%02x%02x", values[0], values[1], values[2], values[3]);
+            CODA_CHECK(std::strcmp(hex, expected) == 0);
+
+            float decoded[4];
+            CODA_CHECK(rgbaFromHex(decoded, hex));
+            CODA_CHECK(std::memcmp(decoded, rgba, sizeof(rgba)) == 0);
+
+            char encoded[HEX_RGBA_SIZE];
+            rgbaToHex(encoded, decoded);
+            CODA_CHECK(std::strcmp(encoded, hex) == 0);
+        }
+    }
+}
+
+
+/**
+ * Upper case digits are decoded, missing components are 1 and strings
+ * without the leading '#' are rejected.
+ */
+static void testDecode()
+{
+    float rgba[4];
+    CODA_CHECK(rgbaFromHex(rgba, "#FF8000"));
+    CODA_CHECK(rgba[0] == 1.0f && rgba[1] == 128.0f/255.0f && rgba[2] == 0.0f && rgba[3] == 1.0f);
+
+    CODA_CHECK(!rgbaFromHex(rgba, "ff8000ff"));
+    CODA_CHECK(!rgbaFromHex(rgba, nullptr));
+    CODA_CHECK(rgba[0] == 1.0f && rgba[1] == 1.0f && rgba[2] == 1.0f && rgba[3] == 1.0f);
+}
+
+
+/**
+ * The column codecs match the single color codecs.
+ */
+static void testColumns()
+{
+    const std::int64_t ncolors = 100000;
+    std::vector<float> rgba(4*ncolors);
+    for(std::int64_t i = 0; i < 4*ncolors; ++i)
+    {
+        rgba[i] = static_cast<float>((i*37) % 256)/255.0f;
+    }
+
+    std::vector<char> hex(HEX_RGBA_SIZE*ncolors);
+    rgbaToHexColumn(hex.data(), rgba.data(), ncolors);
+
+    std::vector<float> decoded(4*ncolors);
+    rgbaFromHexColumn(decoded.data(), hex.data(), ncolors);
+    CODA_CHECK(decoded == rgba);
+
+    for(std::int64_t icolor = 0; icolor < ncolors; ++icolor)
+    {
+        char expected[HEX_RGBA_SIZE];
+        rgbaToHex(expected, &rgba[4*icolor]);
+        CODA_CHECK(std::strcmp(&hex[HEX_RGBA_SIZE*icolor], expected) == 0);
+    }
+}
+
+
+int main()
+{
+    testRoundTrip();
+    testDecode();
+    testColumns();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+// STL
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Local
+#include <hxcoda/internal/LabelFilter.h>
+#include <hxcoda/internal/LabelIndex.h>
+#include <hxcoda/tests/TestUtils.h>
+
+
+using namespace coda;
+
+
+static const std::int64_t NX = 64;
+static const std::int64_t NY = 48;
+static const std::int64_t NZ = 32;
+static const int NLABELS = 200;
+
+
+/**
+ * Returns a random uint16 label field with runs of equal labels.
+ */
+static std::vector<std::uint16_t> randomLabels()
+{
+    std::mt19937 random(7);
+    std::vector<std::uint16_t> labels(NX*NY*NZ);
+    for(std::size_t i = 0; i < labels.size(); ++i)
+    {
+        labels[i] = i % 5 == 0 ? static_cast<std::uint16_t>(random() % (NLABELS + 1)) : labels[i > 0 ? i - 1 : 0];
+    }
+    return labels;
+}
+
+
+static std::vector<bool> randomSelection(unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::vector<bool> selection(NLABELS);
+    for(int irow = 0; irow < NLABELS; ++irow)
+    {
+        selection[irow] = random() % 2 == 0;
+    }
+    return selection;
+}
+
+
+/**
+ * An incremental update gives the same voxels as filtering from scratch.
+ */
+static void testApply()
+{
+    const std::vector<std::uint16_t> input = randomLabels();
+    const std::vector<bool> previous = randomSelection(1);
+    const std::vector<bool> selection = randomSelection(2);
+
+    std::vector<std::uint16_t> result(input.size());
+    std::vector<std::uint16_t> expected(input.size());
+    filterLabelKernel(result.data(), input.data(), McPrimType::MC_UINT16, NX*NY, NZ, previous);
+    filterLabelKernel(expected.data(), input.data(), McPrimType::MC_UINT16, NX*NY, NZ, selection);
+
+    LabelIndex index;
+    CODA_CHECK(index.build(input.data(), McPrimType::MC_UINT16, NX, NY, NZ));
+    CODA_CHECK(index.matches(McPrimType::MC_UINT16, NX, NY, NZ));
+    CODA_CHECK(index.apply(result.data(), selection, previous) > 0);
+    CODA_CHECK(result == expected);
+}
+
+
+/**
+ * A cancelled build leaves an empty index and a cancelled update stops
+ * before it writes a label.
+ */
+static void testCancel()
+{
+    const std::vector<std::uint16_t> input = randomLabels();
+    const std::vector<bool> previous = randomSelection(1);
+    const std::vector<bool> selection = randomSelection(2);
+
+    LabelIndex index;
+    std::atomic<int> ncalls(0);
+    CODA_CHECK(!index.build(input.data(), McPrimType::MC_UINT16, NX, NY, NZ, [&]() {
+        return ++ncalls > 3;
+    }));
+    CODA_CHECK(index.isEmpty());
+
+    CODA_CHECK(index.build(input.data(), McPrimType::MC_UINT16, NX, NY, NZ));
+
+    std::vector<std::uint16_t> result(input.size());
+    filterLabelKernel(result.data(), input.data(), McPrimType::MC_UINT16, NX*NY, NZ, previous);
+    const std::vector<std::uint16_t> unchanged = result;
+
+    index.apply(result.data(), selection, previous, []() { return true; });
+    CODA_CHECK(result == unchanged);
+}
+
+
+int main()
+{
+    testApply();
+    testCancel();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Local
+#include <hxcoda/internal/SelectionCsv.h>
+#include <hxcoda/tests/TestUtils.h>
+
+
+using namespace coda;
+
+
+/// More rows than a 32 bit index can address.
+static const std::int64_t NROWS = (std::int64_t(1) << 31) + 100;
+
+
+/// The selected rows of the synthetic table, in ascending order.
+static const std::vector<std::int64_t> SELECTED_ROWS = {
+    0,
+    12345678,
+    std::numeric_limits<int>::max() - 1,
+    std::numeric_limits<int>::max(),
+    std::int64_t(1) << 31,
+    NROWS - 1
+};
+
+
+/**
+ * Reads a synthetic selection file with NROWS rows. The file is generated
+ * block by block, so it never exists as a whole.
+ */
+static void testRead(std::vector<bool>& selection)
+{
+    const std::string header = "selected\n";
+
+    // Each row is "0\n" or "1\n".
+    std::int64_t offset = -1;
+    std::vector<SelectionColumn> columns;
+    const bool ok = readSelectionCsv(columns, [&](char* data, std::int64_t size) -> std::int64_t {
+        if(offset < 0)
+        {
+            offset = 0;
+            std::memcpy(data, header.data(), header.size());
+            return static_cast<std::int64_t>(header.size());
+        }
+
+        const std::int64_t first = offset/2;
+        const std::int64_t last = std::min(NROWS, first + size/2);
+        for(std::int64_t irow = first; irow < last; ++irow)
+        {
+            data[2*(irow - first)] = '0';
+            data[2*(irow - first) + 1] = '\n';
+        }
+        for(const std::int64_t irow : SELECTED_ROWS)
+        {
+            if(first <= irow && irow < last)
+            {
+                data[2*(irow - first)] = '1';
+            }
+        }
+
+        offset += 2*(last - first);
+        return 2*(last - first);
+    });
+
+    CODA_CHECK(ok);
+    CODA_CHECK(columns.size() == 1);
+    CODA_CHECK(static_cast<std::int64_t>(columns[0].mask.size()) == NROWS);
+
+    selection.swap(columns[0].mask);
+    for(const std::int64_t irow : SELECTED_ROWS)
+    {
+        CODA_CHECK(selection[irow]);
+        selection[irow] = false;
+    }
+    CODA_CHECK(std::find(selection.begin(), selection.end(), true) == selection.end());
+    for(const std::int64_t irow : SELECTED_ROWS)
+    {
+        selection[irow] = true;
+    }
+}
+
+
+/**
+ * Writes the *selection* of testRead() and checks the row of every
+ * selected field in the output.
+ */
+static void testWrite(const std::vector<bool>& selection)
+{
+    std::int64_t offset = 0;
+    std::vector<std::int64_t> rows;
+    const bool ok = writeSelectionCsv(
+        [&](const char* data, std::int64_t size) {
+            const char* end = data + size;
+            const char* one = static_cast<const char*>(std::memchr(data, '1', size));
+            while(one)
+            {
+                // Skip the 9 bytes of the header.
+                rows.push_back((offset + (one - data) - 9)/2);
+                one = static_cast<const char*>(std::memchr(one + 1, '1', end - one - 1));
+            }
+            offset += size;
+            return true;
+        },
+        {"selected"},
+        {&selection}
+    );
+
+    CODA_CHECK(ok);
+    CODA_CHECK(offset == 9 + 2*NROWS);
+    CODA_CHECK(rows == SELECTED_ROWS);
+}
+
+
+int main()
+{
+    std::vector<bool> selection;
+    testRead(selection);
+    testWrite(selection);
+    return 0;
+}
\ No newline at end of file
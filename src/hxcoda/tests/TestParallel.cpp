@@ -0,0 +1,115 @@
+// STL
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Local
+#include <hxcoda/internal/Parallel.h>
+#include <hxcoda/tests/TestUtils.h>
+
+
+using namespace coda;
+
+
+/**
+ * Every chunk is processed exactly once.
+ */
+static void testChunks()
+{
+    for(std::int64_t nchunks : {0, 1, 2, 7, 1000})
+    {
+        std::vector<std::atomic<int>> counts(nchunks);
+        for(auto& count : counts)
+        {
+            count = 0;
+        }
+
+        parallelForChunks(nchunks, [&](std::int64_t ichunk) {
+            ++counts[ichunk];
+        });
+
+        for(const auto& count : counts)
+        {
+            CODA_CHECK(count == 1);
+        }
+    }
+}
+
+
+/**
+ * The blocks cover the range without gaps or overlaps, and ranges
+ * below two grains are processed on the calling thread.
+ */
+static void testBlocks()
+{
+    const std::int64_t begin = 17;
+    const std::int64_t end = 100017;
+
+    std::vector<std::atomic<int>> counts(end - begin);
+    for(auto& count : counts)
+    {
+        count = 0;
+    }
+
+    parallelFor(begin, end, 100, [&](std::int64_t first, std::int64_t last) {
+        for(std::int64_t i = first; i < last; ++i)
+        {
+            ++counts[i - begin];
+        }
+    });
+
+    for(const auto& count : counts)
+    {
+        CODA_CHECK(count == 1);
+    }
+
+    const std::thread::id caller = std::this_thread::get_id();
+    parallelFor(0, 150, 100, [&](std::int64_t first, std::int64_t last) {
+        CODA_CHECK(first == 0 && last == 150);
+        CODA_CHECK(std::this_thread::get_id() == caller);
+    });
+}
+
+
+/**
+ * Nested loops and loops started by several threads at once complete.
+ */
+static void testNestedAndConcurrent()
+{
+    std::atomic<std::int64_t> sum(0);
+    parallelForChunks(16, [&](std::int64_t) {
+        parallelFor(0, 10000, 10, [&](std::int64_t first, std::int64_t last) {
+            sum += last - first;
+        });
+    });
+    CODA_CHECK(sum == 16*10000);
+
+    sum = 0;
+    std::vector<std::thread> threads;
+    for(int ithread = 0; ithread < 4; ++ithread)
+    {
+        threads.emplace_back([&]() {
+            for(int irun = 0; irun < 100; ++irun)
+            {
+                parallelFor(0, 1000, 10, [&](std::int64_t first, std::int64_t last) {
+                    sum += last - first;
+                });
+            }
+        });
+    }
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+    CODA_CHECK(sum == 4*100*1000);
+}
+
+
+int main()
+{
+    testChunks();
+    testBlocks();
+    testNestedAndConcurrent();
+    return 0;
+}
\ No newline at end of file
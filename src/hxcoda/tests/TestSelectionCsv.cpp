@@ -0,0 +1,107 @@
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Local
+#include <hxcoda/internal/SelectionCsv.h>
+#include <hxcoda/tests/TestUtils.h>
+
+
+using namespace coda;
+
+
+/**
+ * Parses the selection file *text*, passing it in blocks of at most
+ * *block_size* bytes to the reader.
+ */
+static bool readText(
+    std::vector<SelectionColumn>& columns,
+    const std::string& text,
+    std::int64_t block_size
+) {
+    std::size_t offset = 0;
+    return readSelectionCsv(columns, [&](char* data, std::int64_t size) {
+        const std::size_t n = std::min<std::size_t>(
+            text.size() - offset, static_cast<std::size_t>(std::min(size, block_size))
+        );
+        std::memcpy(data, text.data() + offset, n);
+        offset += n;
+        return static_cast<std::int64_t>(n);
+    });
+}
+
+
+/**
+ * The masks are written and read back. The shorter mask is padded with
+ * unselected rows.
+ */
+static void testRoundTrip()
+{
+    const std::vector<bool> selection = {true, false, false, true, true};
+    const std::vector<bool> table_selection = {false, true};
+
+    std::string text;
+    const bool ok = writeSelectionCsv(
+        [&](const char* data, std::int64_t size) {
+            text.append(data, static_cast<std::size_t>(size));
+            return true;
+        },
+        {"selected", "selected_2"},
+        {&selection, &table_selection}
+    );
+    CODA_CHECK(ok);
+    CODA_CHECK(text == "selected,selected_2\n1,0\n0,1\n0,0\n1,0\n1,0\n");
+
+    for(std::int64_t block_size : {1, 3, 1 << 20})
+    {
+        std::vector<SelectionColumn> columns;
+        CODA_CHECK(readText(columns, text, block_size));
+        CODA_CHECK(columns.size() == 2);
+        CODA_CHECK(columns[0].name == "selected");
+        CODA_CHECK(columns[0].mask == selection);
+        CODA_CHECK(columns[1].name == "selected_2");
+        CODA_CHECK(columns[1].mask == std::vector<bool>({false, true, false, false, false}));
+    }
+}
+
+
+/**
+ * Files written by other tools: quoted names, other separators, carriage
+ * returns, other columns, float values and a missing final newline.
+ */
+static void testFormats()
+{
+    std::vector<SelectionColumn> columns;
+
+    CODA_CHECK(readText(columns, "\"index\",\"selected\"\r\n0,1\r\n1,0\r\n\r\n2,1", 1 << 20));
+    CODA_CHECK(columns.size() == 1);
+    CODA_CHECK(columns[0].name == "selected");
+    CODA_CHECK(columns[0].mask == std::vector<bool>({true, false, true}));
+
+    CODA_CHECK(readText(columns, "selected_0;selected\n1.0;0.5\n0;2e3\n", 1 << 20));
+    CODA_CHECK(columns.size() == 2);
+    CODA_CHECK(columns[0].mask == std::vector<bool>({true, false}));
+    CODA_CHECK(columns[1].mask == std::vector<bool>({false, true}));
+
+    // Missing fields are unselected.
+    CODA_CHECK(readText(columns, "selected,selected_1\n1\n0,1\n", 1 << 20));
+    CODA_CHECK(columns[0].mask == std::vector<bool>({true, false}));
+    CODA_CHECK(columns[1].mask == std::vector<bool>({false, true}));
+
+    // A file without selection columns.
+    CODA_CHECK(readText(columns, "label,count\n1,2\n", 1 << 20));
+    CODA_CHECK(columns.empty());
+
+    CODA_CHECK(!readText(columns, "", 1 << 20));
+}
+
+
+int main()
+{
+    testRoundTrip();
+    testFormats();
+    return 0;
+}
\ No newline at end of file
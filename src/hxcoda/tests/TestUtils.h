@@ -0,0 +1,54 @@
+#pragma once
+
+// STL
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+/**
+ * Aborts the test with a message if *condition* is false.
+ */
+#define CODA_CHECK(condition)                                               \
+    do                                                                      \
+    {                                                                       \
+        if(!(condition))                                                    \
+        {                                                                   \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n",               \
+                __FILE__, __LINE__, #condition);                            \
+            std::exit(EXIT_FAILURE);                                        \
+        }                                                                   \
+    } while(false)
+
+
+namespace coda
+{
+namespace test
+{
+
+
+/**
+ * Returns the best wall time of *nruns* calls of *f* in milliseconds.
+ */
+template<typename Function>
+double bestTime(int nruns, Function f)
+{
+    double best = 0.0;
+    for(int irun = 0; irun < nruns; ++irun)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto stop = std::chrono::steady_clock::now();
+
+        const double time = std::chrono::duration<double, std::milli>(stop - start).count();
+        if(irun == 0 || time < best)
+        {
+            best = time;
+        }
+    }
+    return best;
+}
+
+
+} // namespace test
+} // namespace coda
\ No newline at end of file